@@ -0,0 +1,74 @@
+// Generator of benchmark input for medals.
+// Usage: generate_input number_of_countries number_of_queries updates_per_query seed
+// All countries get a medal first, then each ranking query is preceded by given number of random medals
+// awarded or revoked. Only awarded medals are revoked, so the input contains no errors.
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    // Names are distinct because they encode numbers of countries.
+    string country_name(size_t country) {
+        string name = "C";
+        do {
+            name += static_cast<char>('a' + country % 26);
+            country /= 26;
+        } while (country > 0);
+        return name;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 5) {
+        fprintf(stderr, "Usage: %s number_of_countries number_of_queries updates_per_query seed\n", argv[0]);
+        return 1;
+    }
+    const size_t number_of_countries = strtoull(argv[1], nullptr, 10);
+    const size_t number_of_queries = strtoull(argv[2], nullptr, 10);
+    const size_t updates_per_query = strtoull(argv[3], nullptr, 10);
+    mt19937_64 generator(strtoull(argv[4], nullptr, 10));
+    if (number_of_countries == 0) {
+        fprintf(stderr, "There has to be at least one country.\n");
+        return 1;
+    }
+
+    vector<string> names(number_of_countries);
+    vector<array<size_t, 3>> medals(number_of_countries);
+    string output;
+    for (size_t country = 0; country < number_of_countries; country++) {
+        names[country] = country_name(country);
+        const size_t medal = generator() % 3;
+        medals[country][medal]++;
+        output += names[country] + " " + to_string(medal + 1) + "\n";
+    }
+
+    for (size_t query = 0; query < number_of_queries; query++) {
+        for (size_t update = 0; update < updates_per_query; update++) {
+            const size_t country = generator() % number_of_countries;
+            const size_t medal = generator() % 3;
+            if (medals[country][medal] > 0 && generator() % 3 == 0) {
+                medals[country][medal]--;
+                output += "-" + names[country] + " " + to_string(medal + 1) + "\n";
+            }
+            else {
+                medals[country][medal]++;
+                output += names[country] + " " + to_string(medal + 1) + "\n";
+            }
+        }
+        output += "=" + to_string(1 + generator() % 5) + " " + to_string(1 + generator() % 5) + " " +
+                  to_string(1 + generator() % 5) + "\n";
+
+        if (output.size() > (1 << 20)) {
+            fwrite(output.data(), 1, output.size(), stdout);
+            output.clear();
+        }
+    }
+    fwrite(output.data(), 1, output.size(), stdout);
+    return 0;
+}
@@ -0,0 +1,36 @@
+#!/bin/sh
+# Benchmark of ranking queries interleaved with medal updates. Compares medals with its first, regex based
+# version taken from the root commit, which sorts all countries for every query, and checks that both
+# print the same output.
+# Usage: bench/interleaved_benchmark.sh [number_of_countries [number_of_queries [updates_per_query]]]
+set -eu
+
+cd "$(dirname "$0")/.."
+number_of_countries=${1:-20000}
+number_of_queries=${2:-300}
+updates_per_query=${3:-10}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+baseline=$(git rev-list --max-parents=0 HEAD)
+git show "$baseline:Task1/medals.cpp" > "$work/medals_regex.cpp"
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++20 -O2 -DNDEBUG}
+$CXX $CXXFLAGS "$work/medals_regex.cpp" -o "$work/medals_regex"
+$CXX $CXXFLAGS medals.cpp -o "$work/medals"
+$CXX $CXXFLAGS bench/generate_input.cpp -o "$work/generate_input"
+"$work/generate_input" "$number_of_countries" "$number_of_queries" "$updates_per_query" 1 > "$work/input"
+
+# Runs program on the input, writes its output to given file and prints wall clock time in seconds.
+measure() {
+    start=$(date +%s.%N)
+    "$1" < "$work/input" > "$2"
+    end=$(date +%s.%N)
+    echo "$start $end" | awk '{ printf "%.3f\n", $2 - $1 }'
+}
+
+echo "$number_of_countries countries, $number_of_queries queries, $updates_per_query updates per query"
+printf "regex version: %s s\n" "$(measure "$work/medals_regex" "$work/expected.out")"
+printf "medals:        %s s\n" "$(measure "$work/medals" "$work/actual.out")"
+cmp "$work/expected.out" "$work/actual.out"
@@ -0,0 +1,30 @@
+#!/bin/sh
+# Benchmark of medals on a table large enough to be ranked in parallel, run with 1 to given number of threads.
+# Weights of queries are random, so most of them rebuild the whole ranking. Output has to be the same
+# for every number of threads.
+# Usage: bench/scaling_benchmark.sh [max_threads [number_of_countries [number_of_queries]]]
+set -eu
+
+cd "$(dirname "$0")/.."
+max_threads=${1:-$(nproc)}
+number_of_countries=${2:-500000}
+number_of_queries=${3:-20}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++20 -O2 -DNDEBUG -pthread}
+$CXX $CXXFLAGS medals.cpp -o "$work/medals"
+$CXX $CXXFLAGS bench/generate_input.cpp -o "$work/generate_input"
+"$work/generate_input" "$number_of_countries" "$number_of_queries" 10 1 > "$work/input"
+
+echo "$number_of_countries countries, $number_of_queries queries"
+threads=1
+while [ "$threads" -le "$max_threads" ]; do
+    start=$(date +%s.%N)
+    "$work/medals" -j "$threads" "$work/input" > "$work/output.$threads"
+    end=$(date +%s.%N)
+    echo "$start $end" | awk -v threads="$threads" '{ printf "%3d threads: %.3f s\n", threads, $2 - $1 }'
+    cmp "$work/output.1" "$work/output.$threads"
+    threads=$((threads + 1))
+done
@@ -1,103 +1,893 @@
 #include <algorithm>
 #include <array>
-#include <iostream>
-#include <regex>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <set>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Number of types of medals, it can be changed at compilation with -DNUMBER_OF_MEDALS=N.
+#ifndef NUMBER_OF_MEDALS
 #define NUMBER_OF_MEDALS 3
+#endif
 
 typedef size_t medal_t;
 typedef size_t line_t;
 typedef size_t value_of_medal_t;
 typedef size_t score_t;
-typedef std:: pair<size_t, std:: string> score_and_name_t;
+typedef uint32_t country_id_t;
+typedef std:: pair<score_t, country_id_t> score_and_id_t;
 
 using namespace std;
 
-// Compares pairs by first element in descending order and if they're equal by second element lexicographically.
-bool custom_comparator(const score_and_name_t &pair1,const score_and_name_t &pair2) {
-    return pair1.first > pair2.first || (pair1.first == pair2.first && pair1.second < pair2.second);
-}
+template <size_t N>
+using weights_t = array<value_of_medal_t, N>;
 
-void printing_error(size_t number_of_line) {
-    cerr << "ERROR" << " " << number_of_line << endl;
-}
+// Up to this number of types of medals all columns are scored in one unrolled pass.
+constexpr size_t UNROLLED_SCORING_LIMIT = 4;
 
-int main() {
-    // Map with name of country and an array with amount of each type of medal.
-    unordered_map<string, array<medal_t, NUMBER_OF_MEDALS>> classification;
-    string line;
-    line_t number_of_line = 1;
+// Hash allowing to look up countries by string_view without creating temporary string.
+struct name_hash {
+    using is_transparent = void;
+
+    size_t operator()(string_view name) const {
+        return hash<string_view>{}(name);
+    }
+};
 
-    // Regexes checking if input is correct. They work only when NUMBER_OF_MEDALS is equal to three.
-    const regex pattern_adding("([A-Z][a-zA-Z ]*[a-zA-Z]) ([0-3])");
-    const regex pattern_disqualification("-([A-Z][a-zA-Z ]*[a-zA-Z]) ([1-3])");
-    const regex pattern_print_results("=([1-9]\\d{0,5}) ([1-9]\\d{0,5}) ([1-9]\\d{0,5})");
+// Layout of snapshot file: header, N columns of medal counts indexed by id, lengths of names and all names one after
+// another. Numbers are stored in native byte order.
+struct snapshot_header_t {
+    char magic[8];
+    uint64_t number_of_medals;
+    uint64_t number_of_countries;
+    uint64_t names_size;
+};
 
-    while (getline(cin, line)) {
-        smatch splitted_line;
+constexpr char SNAPSHOT_MAGIC[8] = {'M', 'E', 'D', 'A', 'L', 'S', '0', '1'};
 
-        if (regex_match(line, splitted_line, pattern_adding)) {
-            string name_of_country = splitted_line[1];
-            size_t which_medal = stoul(splitted_line[2]);
+bool is_correct_name(string_view name);
 
-            classification.insert({name_of_country, {}});
-            if (which_medal != 0) {
-                classification[name_of_country][which_medal - 1]++;
+// Countries interned into dense ids. Amounts of each type of medal are kept in separate columns indexed by id.
+template <size_t N>
+class medal_table_t {
+public:
+    static constexpr country_id_t NO_COUNTRY = numeric_limits<country_id_t>::max();
+
+    country_id_t find(string_view name) const {
+        auto found_country = ids.find(name);
+        return found_country == ids.end() ? NO_COUNTRY : found_country->second;
+    }
+
+    country_id_t add(string_view name) {
+        auto [new_country, inserted] = ids.emplace(name, static_cast<country_id_t>(names.size()));
+        if (inserted) {
+            names.push_back(new_country->first);
+            for (auto &column: medals) {
+                column.push_back(0);
             }
         }
-        else if (regex_match(line, splitted_line, pattern_disqualification)) {
-            string name_of_country = splitted_line[1];
-            size_t which_medal = stoul(splitted_line[2]);
+        return new_country->second;
+    }
 
-            if (!classification.contains(name_of_country)) {
-                printing_error(number_of_line);
-            }
-            else if (classification[name_of_country][which_medal - 1] > 0) {
-                classification[name_of_country][which_medal - 1]--;
+    size_t size() const {
+        return names.size();
+    }
+
+    string_view name(country_id_t id) const {
+        return names[id];
+    }
+
+    medal_t &medal(country_id_t id, size_t which_medal) {
+        return medals[which_medal][id];
+    }
+
+    // Writes all countries to temporary file, which replaces given one only if everything was written.
+    bool save_snapshot(const char *path) const {
+        const string temporary_path = string(path) + ".tmp";
+        FILE *file = fopen(temporary_path.c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+
+        snapshot_header_t header{};
+        memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.number_of_medals = N;
+        header.number_of_countries = size();
+        vector<uint32_t> lengths_of_names;
+        lengths_of_names.reserve(size());
+        for (string_view name: names) {
+            lengths_of_names.push_back(static_cast<uint32_t>(name.size()));
+            header.names_size += name.size();
+        }
+
+        fwrite(&header, sizeof(header), 1, file);
+        for (auto &column: medals) {
+            if constexpr (sizeof(medal_t) == sizeof(uint64_t)) {
+                fwrite(column.data(), sizeof(medal_t), column.size(), file);
             }
             else {
-                printing_error(number_of_line);
+                for (medal_t count: column) {
+                    const uint64_t stored_count = count;
+                    fwrite(&stored_count, sizeof(stored_count), 1, file);
+                }
             }
         }
-        else if (regex_match(line, splitted_line, pattern_print_results)) {
-            vector<value_of_medal_t> value;
+        fwrite(lengths_of_names.data(), sizeof(uint32_t), lengths_of_names.size(), file);
+        for (string_view name: names) {
+            fwrite(name.data(), 1, name.size(), file);
+        }
 
-            for (size_t i = 1; i < NUMBER_OF_MEDALS + 1; i++) {
-                value.push_back(stoul(splitted_line[i]));
-            }
+        const bool is_written = !ferror(file);
+        if (fclose(file) != 0 || !is_written || rename(temporary_path.c_str(), path) != 0) {
+            remove(temporary_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // Adds countries from memory mapped snapshot, so loading takes time proportional to number of countries.
+    bool load_snapshot(const char *path) {
+        const int file_descriptor = open(path, O_RDONLY);
+        if (file_descriptor < 0) {
+            return false;
+        }
+
+        struct stat file_status;
+        void *mapping = MAP_FAILED;
+        if (fstat(file_descriptor, &file_status) == 0 &&
+            static_cast<size_t>(file_status.st_size) >= sizeof(snapshot_header_t)) {
+            mapping = mmap(nullptr, file_status.st_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+        }
+        close(file_descriptor);
+        if (mapping == MAP_FAILED) {
+            return false;
+        }
+
+        const bool is_loaded = load_snapshot(static_cast<const char *>(mapping), file_status.st_size);
+        munmap(mapping, file_status.st_size);
+        return is_loaded;
+    }
+
+    // Sum over types of medals is unrolled at compile time.
+    score_t calculate_score(country_id_t id, const weights_t<N> &value) const {
+        return [&]<size_t... I>(index_sequence<I...>) {
+            return (score_t{0} + ... + (value[I] * medals[I][id]));
+        }(make_index_sequence<N>{});
+    }
 
-            // Vector with score of each country and it's name.
-            vector<score_and_name_t> ranking;
-            
-            // Calculating score of each country and making vector of pairs with score and name of country.
-            for (auto &countries: classification) {
-                string name = countries.first;
-                size_t score = 0;
+    // Writes scores of countries with ids from range [first, last) to countries[first, last) in simple vectorizable
+    // loops. For few types of medals all columns are read in one pass, otherwise scores are added column by column.
+    void calculate_scores(const weights_t<N> &value, score_and_id_t *countries, size_t first, size_t last) const {
+        if constexpr (N <= UNROLLED_SCORING_LIMIT) {
+            [&]<size_t... I>(index_sequence<I...>) {
+                const array<const medal_t *, N> columns = {medals[I].data()...};
 
-                for (size_t i = 0; i < NUMBER_OF_MEDALS; i++) {
-                    score += value[i] * countries.second[i];
+                for (size_t id = first; id < last; id++) {
+                    countries[id] = {(score_t{0} + ... + (value[I] * columns[I][id])), static_cast<country_id_t>(id)};
                 }
-                ranking.push_back({score, name});
+            }(make_index_sequence<N>{});
+        }
+        else {
+            for (size_t id = first; id < last; id++) {
+                countries[id] = {0, static_cast<country_id_t>(id)};
             }
 
-            sort(ranking.begin(), ranking.end(), custom_comparator);
+            for (size_t i = 0; i < N; i++) {
+                const medal_t *column = medals[i].data();
+                const value_of_medal_t weight = value[i];
 
-            size_t place = 1;
-            for (size_t i = 0; i < ranking.size(); i++) {
-                // If country has lower score than previous one it's not placed ex aequo so it's position is changed.
-                if (i != 0 && ranking[i-1].first != ranking[i].first) {
-                    place = i + 1;
+                for (size_t id = first; id < last; id++) {
+                    countries[id].first += weight * column[id];
                 }
-                cout << place << ". " << ranking[i].second << endl;
             }
         }
+    }
+
+private:
+    // Every size read from snapshot is checked against number of bytes left after previous parts, so no sum
+    // can overflow. Names have to end exactly at the end of file and be correct and distinct. On failure table
+    // can be partially filled and shouldn't be used.
+    bool load_snapshot(const char *snapshot, size_t snapshot_size) {
+        snapshot_header_t header;
+        memcpy(&header, snapshot, sizeof(header));
+        if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 || header.number_of_medals != N ||
+            header.number_of_countries >= NO_COUNTRY) {
+            return false;
+        }
+
+        size_t remaining = snapshot_size - sizeof(header);
+        const size_t bytes_per_country = N * sizeof(uint64_t) + sizeof(uint32_t);
+        if (header.number_of_countries > remaining / bytes_per_country) {
+            return false;
+        }
+        const size_t number_of_countries = header.number_of_countries;
+        remaining -= number_of_countries * bytes_per_country;
+        if (header.names_size != remaining) {
+            return false;
+        }
+
+        const char *columns = snapshot + sizeof(header);
+        const char *lengths_of_names = columns + N * number_of_countries * sizeof(uint64_t);
+        const char *next_name = lengths_of_names + number_of_countries * sizeof(uint32_t);
+        const char *end_of_names = snapshot + snapshot_size;
+
+        ids.reserve(size() + number_of_countries);
+        for (size_t i = 0; i < number_of_countries; i++) {
+            uint32_t length_of_name;
+            memcpy(&length_of_name, lengths_of_names + i * sizeof(uint32_t), sizeof(length_of_name));
+            if (static_cast<size_t>(end_of_names - next_name) < length_of_name) {
+                return false;
+            }
+
+            const string_view name(next_name, length_of_name);
+            if (!is_correct_name(name) || find(name) != NO_COUNTRY) {
+                return false;
+            }
+            const country_id_t id = add(name);
+            next_name += length_of_name;
+            for (size_t which_medal = 0; which_medal < N; which_medal++) {
+                uint64_t count;
+                memcpy(&count, columns + (which_medal * number_of_countries + i) * sizeof(uint64_t), sizeof(count));
+                medals[which_medal][id] = count;
+            }
+        }
+        return next_name == end_of_names;
+    }
+
+    unordered_map<string, country_id_t, name_hash, equal_to<>> ids;
+    // Names are views of keys of ids, which don't move after insertion.
+    vector<string_view> names;
+    array<vector<medal_t>, N> medals;
+};
+
+// Compares pairs by score in descending order and if they're equal by name of country lexicographically.
+template <size_t N>
+struct custom_comparator {
+    const medal_table_t<N> *table;
+
+    bool operator()(const score_and_id_t &pair1, const score_and_id_t &pair2) const {
+        return pair1.first > pair2.first ||
+               (pair1.first == pair2.first && table->name(pair1.second) < table->name(pair2.second));
+    }
+};
+
+// Threads started once and reused by every parallel loop, so loops over the table don't pay for creating them.
+// Workers are started on first use, up to given number of threads including the calling one.
+class thread_pool_t {
+public:
+    explicit thread_pool_t(size_t number_of_threads) : number_of_threads(max<size_t>(1, number_of_threads)) {}
+
+    thread_pool_t(const thread_pool_t &) = delete;
+    thread_pool_t &operator=(const thread_pool_t &) = delete;
+
+    ~thread_pool_t() {
+        {
+            lock_guard<mutex> lock(state_mutex);
+            is_stopping = true;
+        }
+        work_started.notify_all();
+        for (auto &worker: workers) {
+            worker.join();
+        }
+    }
+
+    size_t size() const {
+        return number_of_threads;
+    }
+
+    // Runs function(first, last) on consecutive parts of range [0, size) in at most given number of threads.
+    // Calling thread runs the first part and waits for the others.
+    template <typename Function>
+    void parallel_for(size_t size, size_t parts, const Function &function) {
+        parts = max<size_t>(1, min({parts, size, number_of_threads}));
+        if (parts == 1) {
+            function(0, size);
+            return;
+        }
+
+        const size_t part = (size + parts - 1) / parts;
+        const std::function<void(size_t)> run_part = [&function, size, part](size_t index) {
+            if (index * part < size) {
+                function(index * part, min(size, (index + 1) * part));
+            }
+        };
+
+        {
+            lock_guard<mutex> lock(state_mutex);
+            while (workers.size() + 1 < parts) {
+                workers.emplace_back([this, index = workers.size() + 1]() {
+                    work(index);
+                });
+            }
+            task = &run_part;
+            number_of_parts = parts;
+            pending = parts - 1;
+            generation++;
+        }
+        work_started.notify_all();
+        run_part(0);
+
+        unique_lock<mutex> lock(state_mutex);
+        work_done.wait(lock, [this]() {
+            return pending == 0;
+        });
+        task = nullptr;
+    }
+
+private:
+    // Worker with given index runs part with the same index of every loop that has so many parts.
+    void work(size_t index) {
+        size_t seen_generation = 0;
+        unique_lock<mutex> lock(state_mutex);
+        while (true) {
+            work_started.wait(lock, [this, seen_generation]() {
+                return is_stopping || generation != seen_generation;
+            });
+            if (is_stopping) {
+                return;
+            }
+            seen_generation = generation;
+            if (index >= number_of_parts) {
+                continue;
+            }
+
+            const std::function<void(size_t)> *current_task = task;
+            lock.unlock();
+            (*current_task)(index);
+            lock.lock();
+            if (--pending == 0) {
+                work_done.notify_one();
+            }
+        }
+    }
+
+    size_t number_of_threads;
+    vector<thread> workers;
+    mutex state_mutex;
+    condition_variable work_started;
+    condition_variable work_done;
+    // Loop being run, guarded by state_mutex. Generation changes with every loop.
+    const std::function<void(size_t)> *task = nullptr;
+    size_t number_of_parts = 0;
+    size_t pending = 0;
+    size_t generation = 0;
+    bool is_stopping = false;
+};
+
+// Sorts parts of elements in threads of pool and then merges pairs of neighbouring parts, also in parallel.
+// Buffer is used as the second array for merging. Order is the same as after sort, if comparator is a strict
+// total order.
+template <typename T, typename Comparator>
+void parallel_sort(thread_pool_t &pool, vector<T> &elements, vector<T> &buffer, size_t number_of_threads,
+                   Comparator comparator) {
+    const size_t size = elements.size();
+    number_of_threads = max<size_t>(1, min(number_of_threads, size));
+
+    vector<size_t> bounds;
+    for (size_t i = 0; i <= number_of_threads; i++) {
+        bounds.push_back(size * i / number_of_threads);
+    }
+
+    pool.parallel_for(number_of_threads, number_of_threads, [&](size_t first, size_t last) {
+        for (size_t part = first; part < last; part++) {
+            sort(elements.begin() + bounds[part], elements.begin() + bounds[part + 1], comparator);
+        }
+    });
+
+    buffer.resize(size);
+    while (bounds.size() > 2) {
+        const size_t merges = (bounds.size() - 1) / 2;
+
+        pool.parallel_for(merges, merges, [&](size_t first, size_t last) {
+            for (size_t merge_index = first; merge_index < last; merge_index++) {
+                const size_t begin = bounds[2 * merge_index];
+                const size_t middle = bounds[2 * merge_index + 1];
+                const size_t end = bounds[2 * merge_index + 2];
+                merge(elements.begin() + begin, elements.begin() + middle, elements.begin() + middle,
+                      elements.begin() + end, buffer.begin() + begin, comparator);
+            }
+        });
+
+        // Part without a pair is only copied.
+        if ((bounds.size() - 1) % 2 == 1) {
+            copy(elements.begin() + bounds[bounds.size() - 2], elements.end(),
+                 buffer.begin() + bounds[bounds.size() - 2]);
+        }
+
+        vector<size_t> merged_bounds;
+        for (size_t i = 0; i < bounds.size(); i += 2) {
+            merged_bounds.push_back(bounds[i]);
+        }
+        if (merged_bounds.back() != size) {
+            merged_bounds.push_back(size);
+        }
+        bounds = move(merged_bounds);
+        swap(elements, buffer);
+    }
+}
+
+// Checks if one set of weights is a multiple of the other, so both of them give the same ranking.
+template <size_t N>
+bool are_proportional(const weights_t<N> &value1, const weights_t<N> &value2) {
+    for (size_t i = 1; i < N; i++) {
+        if (value1[i] * value2[0] != value2[i] * value1[0]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Ranking of all countries kept sorted for weights of the last ranking request.
+// Every change of medals moves only one country in O(log n), so repeated requests don't sort again.
+template <size_t N>
+class ranking_index_t {
+public:
+    typedef set<score_and_id_t, custom_comparator<N>> ranking_t;
+
+    // Scoring and sorting all countries is split into given number of threads, but only for large tables.
+    ranking_index_t(const medal_table_t<N> &table, size_t number_of_threads)
+        : table(table), ranking(custom_comparator<N>{&table}), pool(number_of_threads) {}
+
+    bool is_sorted_for(const weights_t<N> &value) const {
+        return is_built && are_proportional(weights, value);
+    }
+
+    // Makes ranking sorted for given weights. It's rebuilt only if they don't give the same order as current ones.
+    const ranking_t &get_ranking(const weights_t<N> &value) {
+        if (is_sorted_for(value)) {
+            return ranking;
+        }
+
+        score_countries(value);
+        sort_countries();
+
+        // Elements are already sorted, so each one is inserted at the end in amortized constant time.
+        ranking = ranking_t(sorted_countries.begin(), sorted_countries.end(), custom_comparator<N>{&table});
+        weights = value;
+        is_built = true;
+        return ranking;
+    }
+
+    // Returns sorted countries placed not lower than limit, including all countries ex aequo on last place.
+    // Only they are sorted after partial selection, ranking itself isn't changed.
+    const vector<score_and_id_t> &select_top(const weights_t<N> &value, size_t limit) {
+        score_countries(value);
+        if (limit >= sorted_countries.size()) {
+            sort_countries();
+            return sorted_countries;
+        }
+
+        auto last_place = sorted_countries.begin() + (limit - 1);
+        nth_element(sorted_countries.begin(), last_place, sorted_countries.end(), custom_comparator<N>{&table});
+
+        // Countries with the same score as the one on last place share it, the rest is placed lower than limit.
+        const score_t lowest_score = last_place->first;
+        auto end_of_top = partition(last_place + 1, sorted_countries.end(),
+                                    [lowest_score](const score_and_id_t &country) {
+                                        return country.first == lowest_score;
+                                    });
+        sorted_countries.erase(end_of_top, sorted_countries.end());
+        sort(sorted_countries.begin(), sorted_countries.end(), custom_comparator<N>{&table});
+        return sorted_countries;
+    }
+
+    // Has to be called after country is added to the table or after its medals changed.
+    void add_country(country_id_t id) {
+        if (is_built) {
+            ranking.insert({table.calculate_score(id, weights), id});
+        }
+    }
+
+    // Changes medals of country with given function and moves it to its new place. Its node is extracted
+    // and inserted again with the new score, so no memory is allocated or freed.
+    template <typename Change>
+    void update_country(country_id_t id, Change change) {
+        if (!is_built) {
+            change();
+            return;
+        }
+
+        auto node = ranking.extract({table.calculate_score(id, weights), id});
+        change();
+        node.value().first = table.calculate_score(id, weights);
+        ranking.insert(move(node));
+    }
+
+private:
+    // Below this number of countries waking threads costs more than scoring and sorting.
+    static constexpr size_t PARALLEL_LIMIT = 1 << 15;
+
+    size_t threads_for_table() const {
+        return table.size() < PARALLEL_LIMIT ? 1 : pool.size();
+    }
+
+    void score_countries(const weights_t<N> &value) {
+        sorted_countries.resize(table.size());
+        pool.parallel_for(table.size(), threads_for_table(), [this, &value](size_t first, size_t last) {
+            table.calculate_scores(value, sorted_countries.data(), first, last);
+        });
+    }
+
+    void sort_countries() {
+        if (threads_for_table() > 1) {
+            parallel_sort(pool, sorted_countries, merge_buffer, threads_for_table(), custom_comparator<N>{&table});
+        }
+        else {
+            sort(sorted_countries.begin(), sorted_countries.end(), custom_comparator<N>{&table});
+        }
+    }
+
+    const medal_table_t<N> &table;
+    ranking_t ranking;
+    weights_t<N> weights{};
+    bool is_built = false;
+    thread_pool_t pool;
+    // Buffers reused by every rebuild of ranking.
+    vector<score_and_id_t> sorted_countries;
+    vector<score_and_id_t> merge_buffer;
+};
+
+// Reads lines without copying them. Regular files are memory mapped, other input is read in large chunks.
+class line_reader_t {
+public:
+    explicit line_reader_t(int file_descriptor) : file_descriptor(file_descriptor) {
+        struct stat file_status;
+        if (fstat(file_descriptor, &file_status) == 0 && S_ISREG(file_status.st_mode) && file_status.st_size > 0) {
+            void *mapping = mmap(nullptr, file_status.st_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+            if (mapping != MAP_FAILED) {
+                madvise(mapping, file_status.st_size, MADV_SEQUENTIAL);
+                mapped_file = string_view(static_cast<const char *>(mapping), file_status.st_size);
+                unread = mapped_file;
+                end_of_input = true;
+                return;
+            }
+        }
+        buffer.resize(CHUNK_SIZE);
+    }
+
+    line_reader_t(const line_reader_t &) = delete;
+    line_reader_t &operator=(const line_reader_t &) = delete;
+
+    ~line_reader_t() {
+        if (!mapped_file.empty()) {
+            munmap(const_cast<char *>(mapped_file.data()), mapped_file.size());
+        }
+    }
+
+    // Works like getline, so line after last newline character is returned only if it's not empty.
+    // Returned line is valid until next call.
+    bool next_line(string_view &line) {
+        size_t end_of_line;
+        while ((end_of_line = unread.find('\n')) == string_view::npos && !end_of_input) {
+            read_chunk();
+        }
+
+        if (end_of_line != string_view::npos) {
+            line = unread.substr(0, end_of_line);
+            unread.remove_prefix(end_of_line + 1);
+            return true;
+        }
+        if (unread.empty()) {
+            return false;
+        }
+        line = unread;
+        unread = string_view();
+        return true;
+    }
+
+private:
+    static constexpr size_t CHUNK_SIZE = 1 << 16;
+
+    // Moves unread part of line to the beginning of buffer and reads next chunk after it.
+    void read_chunk() {
+        const size_t unread_size = unread.size();
+        if (unread_size > 0) {
+            memmove(buffer.data(), unread.data(), unread_size);
+        }
+        if (buffer.size() - unread_size < CHUNK_SIZE) {
+            buffer.resize(unread_size + CHUNK_SIZE);
+        }
+
+        ssize_t read_size;
+        do {
+            read_size = read(file_descriptor, buffer.data() + unread_size, buffer.size() - unread_size);
+        } while (read_size < 0 && errno == EINTR);
+
+        if (read_size <= 0) {
+            end_of_input = true;
+            read_size = 0;
+        }
+        unread = string_view(buffer.data(), unread_size + read_size);
+    }
+
+    int file_descriptor;
+    vector<char> buffer;
+    string_view mapped_file;
+    string_view unread;
+    bool end_of_input = false;
+};
+
+// Output collected in one reusable buffer, which is written with a single call after each request.
+class output_buffer_t {
+public:
+    void append(string_view text) {
+        buffer.append(text);
+    }
+
+    void append(size_t number) {
+        char digits[numeric_limits<size_t>::digits10 + 1];
+        auto result = to_chars(begin(digits), end(digits), number);
+        buffer.append(digits, result.ptr);
+    }
+
+    void flush() {
+        if (!buffer.empty()) {
+            fwrite(buffer.data(), 1, buffer.size(), stdout);
+            fflush(stdout);
+            buffer.clear();
+        }
+    }
+
+private:
+    string buffer;
+};
+
+// Standard output is flushed after every request, so errors stay in order with it.
+void printing_error(size_t number_of_line) {
+    fprintf(stderr, "ERROR %zu\n", number_of_line);
+}
+
+bool is_upper_letter(char c) {
+    return c >= 'A' && c <= 'Z';
+}
+
+bool is_letter(char c) {
+    return is_upper_letter(c) || (c >= 'a' && c <= 'z');
+}
+
+bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Checks if name starts with uppercase letter, ends with letter and contains only letters and spaces.
+bool is_correct_name(string_view name) {
+    if (name.size() < 2 || !is_upper_letter(name.front()) || !is_letter(name.back())) {
+        return false;
+    }
+    for (char c: name) {
+        if (!is_letter(c) && c != ' ') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Splits line in format "<name> <digit>" where digit is from range [lowest_medal, N].
+template <size_t N>
+bool parse_medal_line(string_view line, size_t lowest_medal, string_view &name, size_t &which_medal) {
+    if (line.size() < 4 || line[line.size() - 2] != ' ' || !is_digit(line.back())) {
+        return false;
+    }
+    which_medal = line.back() - '0';
+    name = line.substr(0, line.size() - 2);
+    return which_medal >= lowest_medal && which_medal <= N && is_correct_name(name);
+}
+
+// Parses number from range [1, 999999] without leading zeros starting at given position and moves position after it.
+bool parse_number(string_view line, size_t &position, size_t &number) {
+    if (position >= line.size() || line[position] < '1' || line[position] > '9') {
+        return false;
+    }
+
+    size_t digits = 0;
+    number = 0;
+    while (position < line.size() && is_digit(line[position]) && digits < 6) {
+        number = number * 10 + (line[position++] - '0');
+        digits++;
+    }
+    return true;
+}
+
+// Parses weights separated by single spaces starting at given position and moves position after them.
+template <size_t N>
+bool parse_weights(string_view line, size_t &position, weights_t<N> &value) {
+    for (size_t i = 0; i < N; i++) {
+        if (i != 0 && (position >= line.size() || line[position++] != ' ')) {
+            return false;
+        }
+        if (!parse_number(line, position, value[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Parses line in format "<weight> ... <weight>" with N weights.
+template <size_t N>
+bool parse_weights(string_view line, weights_t<N> &value) {
+    size_t position = 0;
+    return parse_weights(line, position, value) && position == line.size();
+}
+
+// Parses line in format "<limit> <weight> ... <weight>" where limit is the last place that is printed.
+template <size_t N>
+bool parse_top_request(string_view line, size_t &limit, weights_t<N> &value) {
+    size_t position = 0;
+    return parse_number(line, position, limit) && position < line.size() && line[position++] == ' ' &&
+           parse_weights(line, position, value) && position == line.size();
+}
+
+// Prints countries from ranking sorted by custom_comparator whose places are not greater than limit.
+template <size_t N, typename Ranking>
+void print_ranking(const Ranking &ranking, const medal_table_t<N> &table, size_t limit, output_buffer_t &output) {
+    size_t place = 1;
+    size_t i = 0;
+    score_t previous_score = 0;
+    for (auto &country: ranking) {
+        // If country has lower score than previous one it's not placed ex aequo so it's position is changed.
+        if (i != 0 && previous_score != country.first) {
+            place = i + 1;
+        }
+        if (place > limit) {
+            break;
+        }
+        output.append(place);
+        output.append(". ");
+        output.append(table.name(country.second));
+        output.append("\n");
+        previous_score = country.first;
+        i++;
+    }
+}
+
+// Medal classification for N types of medals. Every line of input is processed as soon as it's read.
+template <size_t N>
+class medal_classification_t {
+public:
+    static_assert(N >= 1 && N <= 9, "Type of medal has to be a single positive digit.");
+
+    explicit medal_classification_t(size_t number_of_threads) : ranking_index(table, number_of_threads) {}
+
+    // Snapshot can be loaded only before first line is processed.
+    bool load_snapshot(const char *path) {
+        return table.load_snapshot(path);
+    }
+
+    bool save_snapshot(const char *path) const {
+        return table.save_snapshot(path);
+    }
+
+    medal_classification_t(const medal_classification_t &) = delete;
+    medal_classification_t &operator=(const medal_classification_t &) = delete;
+
+    void process_line(string_view line, line_t number_of_line, output_buffer_t &output) {
+        string_view name_of_country;
+        size_t which_medal;
+        size_t limit;
+        weights_t<N> value;
+
+        // Type of line is determined by its first character, so only one parser is tried.
+        const char first_character = line.empty() ? '\0' : line[0];
+
+        if (is_upper_letter(first_character) && parse_medal_line<N>(line, 0, name_of_country, which_medal)) {
+            country_id_t id = table.find(name_of_country);
+
+            if (id == medal_table_t<N>::NO_COUNTRY) {
+                id = table.add(name_of_country);
+                ranking_index.add_country(id);
+            }
+            if (which_medal != 0) {
+                ranking_index.update_country(id, [this, id, which_medal] {
+                    table.medal(id, which_medal - 1)++;
+                });
+            }
+        }
+        else if (first_character == '-' && parse_medal_line<N>(line.substr(1), 1, name_of_country, which_medal)) {
+            const country_id_t id = table.find(name_of_country);
+
+            if (id == medal_table_t<N>::NO_COUNTRY) {
+                printing_error(number_of_line);
+            }
+            else if (table.medal(id, which_medal - 1) > 0) {
+                ranking_index.update_country(id, [this, id, which_medal] {
+                    table.medal(id, which_medal - 1)--;
+                });
+            }
+            else {
+                printing_error(number_of_line);
+            }
+        }
+        else if (first_character == '=' && parse_weights<N>(line.substr(1), value)) {
+            print_ranking(ranking_index.get_ranking(value), table, numeric_limits<size_t>::max(), output);
+            output.flush();
+        }
+        else if (first_character == '^' && parse_top_request<N>(line.substr(1), limit, value)) {
+            if (ranking_index.is_sorted_for(value)) {
+                print_ranking(ranking_index.get_ranking(value), table, limit, output);
+            }
+            else {
+                print_ranking(ranking_index.select_top(value, limit), table, limit, output);
+            }
+            output.flush();
+        }
         else {
             printing_error(number_of_line);
         }
+    }
+
+private:
+    medal_table_t<N> table;
+    ranking_index_t<N> ranking_index;
+};
+
+// Usage: medals [-j number_of_threads] [-r snapshot] [-s snapshot] [file]
+// Reads input from given file or from standard input. Rankings of large tables are made in given number of threads.
+// Medals can be restored from snapshot before reading input with -r and saved to snapshot after reading it with -s.
+int main(int argc, char *argv[]) {
+    size_t number_of_threads = 1;
+    const char *restored_snapshot = nullptr;
+    const char *saved_snapshot = nullptr;
+    int option;
+    while ((option = getopt(argc, argv, "j:r:s:")) != -1) {
+        if (option == 'r') {
+            restored_snapshot = optarg;
+        }
+        else if (option == 's') {
+            saved_snapshot = optarg;
+        }
+        else if (option != 'j' || (number_of_threads = strtoul(optarg, nullptr, 10)) == 0) {
+            fprintf(stderr, "Usage: %s [-j number_of_threads] [-r snapshot] [-s snapshot] [file]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int input = STDIN_FILENO;
+    if (optind < argc && (input = open(argv[optind], O_RDONLY)) < 0) {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    line_reader_t reader(input);
+    output_buffer_t output;
+    medal_classification_t<NUMBER_OF_MEDALS> classification(number_of_threads);
+    string_view line;
+    line_t number_of_line = 1;
+
+    if (restored_snapshot != nullptr && !classification.load_snapshot(restored_snapshot)) {
+        fprintf(stderr, "%s: cannot load snapshot\n", restored_snapshot);
+        return 1;
+    }
+
+    while (reader.next_line(line)) {
+        classification.process_line(line, number_of_line, output);
         number_of_line++;
     }
+
+    if (input != STDIN_FILENO) {
+        close(input);
+    }
+
+    if (saved_snapshot != nullptr && !classification.save_snapshot(saved_snapshot)) {
+        fprintf(stderr, "%s: cannot save snapshot\n", saved_snapshot);
+        return 1;
+    }
     return 0;
 }
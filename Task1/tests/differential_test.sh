@@ -0,0 +1,41 @@
+#!/bin/sh
+# Differential test of medals against its first, regex based version taken from the root commit.
+# Both programs read the same random inputs from standard input and from a file, and their standard
+# output and standard error have to be identical.
+# Usage: tests/differential_test.sh [number_of_inputs]
+set -eu
+
+cd "$(dirname "$0")/.."
+number_of_inputs=${1:-1000}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+baseline=$(git rev-list --max-parents=0 HEAD)
+git show "$baseline:Task1/medals.cpp" > "$work/medals_regex.cpp"
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++20 -O2 -Wall -Wextra}
+$CXX $CXXFLAGS "$work/medals_regex.cpp" -o "$work/medals_regex"
+$CXX $CXXFLAGS medals.cpp -o "$work/medals"
+$CXX $CXXFLAGS tests/fuzz_input.cpp -o "$work/fuzz_input"
+
+seed=1
+while [ "$seed" -le "$number_of_inputs" ]; do
+    "$work/fuzz_input" "$seed" > "$work/input"
+    "$work/medals_regex" < "$work/input" > "$work/expected.out" 2> "$work/expected.err"
+    for source in stdin file; do
+        if [ "$source" = stdin ]; then
+            "$work/medals" < "$work/input" > "$work/actual.out" 2> "$work/actual.err"
+        else
+            "$work/medals" "$work/input" > "$work/actual.out" 2> "$work/actual.err"
+        fi
+        if ! cmp -s "$work/expected.out" "$work/actual.out" || ! cmp -s "$work/expected.err" "$work/actual.err"; then
+            echo "Outputs differ for seed $seed reading from $source, input:"
+            cat "$work/input"
+            exit 1
+        fi
+    done
+    seed=$((seed + 1))
+done
+
+echo "OK: $number_of_inputs inputs"
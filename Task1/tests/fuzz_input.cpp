@@ -0,0 +1,82 @@
+// Generator of random input for medals, used by differential_test.sh.
+// Usage: fuzz_input seed
+// Lines follow the grammar accepted by the first, regex based version of medals and mutations of it,
+// so output of both versions has to be identical.
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    const vector<string> NAMES = {"Poland", "Po", "USA", "United States", "Ab", "A b", "Ab ", "aB", "Abc d",
+                                  "X", "Zz  z", "Ab1", "Ab  b", " Ab", "Ąb"};
+    const vector<string> NUMBERS = {"1", "9", "0", "01", "999999", "1000000", "123456", "12", "007", "", " 5",
+                                    "4294967296", "18446744073709551617"};
+    const string ALPHABET = "AaZz -=0123456789 \t\r1x";
+
+    mt19937_64 generator;
+
+    size_t random_below(size_t bound) {
+        return uniform_int_distribution<size_t>(0, bound - 1)(generator);
+    }
+
+    template <typename T>
+    const T &random_element(const vector<T> &elements) {
+        return elements[random_below(elements.size())];
+    }
+
+    string random_number() {
+        if (random_below(3) == 0) {
+            return to_string(1 + random_below(999999));
+        }
+        return random_element(NUMBERS);
+    }
+
+    string random_line() {
+        const size_t kind = random_below(100);
+        if (kind < 35) {
+            static const vector<string> separators = {" ", " ", "  ", ""};
+            return random_element(NAMES) + random_element(separators) + "0123456789x"[random_below(11)];
+        }
+        if (kind < 55) {
+            return "-" + random_element(NAMES) + " " + "0123"[random_below(4)];
+        }
+        if (kind < 75) {
+            static const vector<size_t> counts = {3, 3, 3, 2, 4};
+            string line = "=";
+            const size_t count = random_element(counts);
+            for (size_t i = 0; i < count; i++) {
+                line += (i == 0 ? "" : " ") + random_number();
+            }
+            return line;
+        }
+        if (kind < 80) {
+            return "";
+        }
+        string line;
+        for (size_t length = random_below(9); length > 0; length--) {
+            line += ALPHABET[random_below(ALPHABET.size())];
+        }
+        return line;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s seed\n", argv[0]);
+        return 1;
+    }
+    generator.seed(strtoull(argv[1], nullptr, 10));
+
+    string input;
+    for (size_t lines = 1 + random_below(60); lines > 0; lines--) {
+        input += random_line();
+        input += lines > 1 || random_below(2) == 0 ? "\n" : "";
+    }
+    fwrite(input.data(), 1, input.size(), stdout);
+    return 0;
+}
@@ -0,0 +1,94 @@
+#!/bin/sh
+# Test of snapshots of medals. Restored snapshot has to give the same ranking as the input it was saved from,
+# and truncated, corrupted or crafted snapshots have to be rejected without crashing.
+# Crafted snapshots are written in little endian byte order, like snapshots saved on x86.
+# Usage: tests/snapshot_test.sh
+set -eu
+
+cd "$(dirname "$0")/.."
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++20 -O2 -Wall -Wextra -pthread}
+$CXX $CXXFLAGS medals.cpp -o "$work/medals"
+$CXX $CXXFLAGS bench/generate_input.cpp -o "$work/generate_input"
+
+fail() {
+    echo "$1"
+    exit 1
+}
+
+# Runs medals restoring given snapshot on a ranking query and prints its exit status.
+restore() {
+    set +e
+    echo "=1 2 3" | "$work/medals" -r "$1" > "$work/restored.out" 2> /dev/null
+    echo $?
+    set -e
+}
+
+# Writes value as 8 bytes in little endian byte order.
+le64() {
+    i=0
+    while [ "$i" -lt 8 ]; do
+        printf "\\$(printf %03o $(($1 >> (8 * i) & 255)))"
+        i=$((i + 1))
+    done
+}
+
+# Writes value as 4 bytes in little endian byte order.
+le32() {
+    i=0
+    while [ "$i" -lt 4 ]; do
+        printf "\\$(printf %03o $(($1 >> (8 * i) & 255)))"
+        i=$((i + 1))
+    done
+}
+
+# Saved snapshot gives the same ranking as the input.
+"$work/generate_input" 1000 0 0 1 > "$work/input"
+"$work/medals" -s "$work/snapshot" < "$work/input" > /dev/null
+{ cat "$work/input"; echo "=1 2 3"; } | "$work/medals" > "$work/expected.out"
+[ "$(restore "$work/snapshot")" -eq 0 ] || fail "saved snapshot is rejected"
+cmp -s "$work/expected.out" "$work/restored.out" || fail "restored snapshot gives different ranking"
+
+# Every truncated snapshot is rejected and no corrupted one crashes the program.
+printf "Ab 1\nPoland 2\nUnited States 3\n" | "$work/medals" -s "$work/small"
+size=$(wc -c < "$work/small")
+length=0
+while [ "$length" -lt "$size" ]; do
+    head -c "$length" "$work/small" > "$work/truncated"
+    [ "$(restore "$work/truncated")" -eq 1 ] || fail "snapshot truncated to $length bytes is accepted"
+    length=$((length + 1))
+done
+position=0
+while [ "$position" -lt "$size" ]; do
+    for byte in 000 001 177 377; do
+        { head -c "$position" "$work/small"; printf "\\$byte"; tail -c +$((position + 2)) "$work/small"; } \
+            > "$work/corrupted"
+        [ "$(restore "$work/corrupted")" -le 1 ] || fail "snapshot with byte $position set to $byte crashes"
+    done
+    position=$((position + 1))
+done
+
+# Header whose sizes sum to the size of file only after overflow.
+{ printf "MEDALS01"; le64 3; le64 1; le64 -1; le64 0; le64 0; le64 0; printf "\\005\\000\\000"; } > "$work/crafted"
+[ "$(restore "$work/crafted")" -eq 1 ] || fail "snapshot with overflowing size is accepted"
+
+# Names which don't end at the end of file.
+{ printf "MEDALS01"; le64 3; le64 1; le64 3; le64 0; le64 0; le64 0; le32 2; printf "Abc"; } > "$work/crafted"
+[ "$(restore "$work/crafted")" -eq 1 ] || fail "snapshot with bytes after names is accepted"
+
+# Incorrect name.
+{ printf "MEDALS01"; le64 3; le64 1; le64 2; le64 0; le64 0; le64 0; le32 2; printf "ab"; } > "$work/crafted"
+[ "$(restore "$work/crafted")" -eq 1 ] || fail "snapshot with incorrect name is accepted"
+
+# Duplicate names.
+{
+    printf "MEDALS01"; le64 3; le64 2; le64 4
+    for count in 1 2 3 4 5 6; do le64 "$count"; done
+    le32 2; le32 2; printf "AbAb"
+} > "$work/crafted"
+[ "$(restore "$work/crafted")" -eq 1 ] || fail "snapshot with duplicate names is accepted"
+
+echo "OK"
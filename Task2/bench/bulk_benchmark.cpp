@@ -0,0 +1,87 @@
+// Benchmark of bulk functions against loops of single element calls: strqueue_insert_many against
+// strqueue_insert_at, strqueue_get_range against strqueue_get_at and strqueue_remove_range against
+// strqueue_remove_at. Bulk functions are called for batches of given size. Reports time per element.
+// Build it with and without NDEBUG, see bulk_benchmark.sh.
+// Usage: bulk_benchmark [number_of_strings [batch_size]]
+
+#include "../strqueue.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+    using namespace cxx;
+
+    template <typename Function>
+    double nanoseconds_per_element(std::size_t number_of_strings, Function function) {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / number_of_strings;
+    }
+
+    void report(const char *single, double single_time, const char *bulk, double bulk_time) {
+        std::printf("%-20s %8.1f ns   %-20s %8.1f ns\n", single, single_time, bulk, bulk_time);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const std::size_t number_of_strings = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const std::size_t batch_size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000;
+    if (number_of_strings == 0 || batch_size == 0) {
+        std::fprintf(stderr, "There has to be at least one string and batches can't be empty.\n");
+        return 1;
+    }
+
+    std::vector<std::string> strings(number_of_strings);
+    std::vector<const char *> strs(number_of_strings);
+    for (std::size_t i = 0; i < number_of_strings; i++) {
+        strings[i] = "string number " + std::to_string(i);
+        strs[i] = strings[i].c_str();
+    }
+    std::vector<const char *> read(number_of_strings);
+
+    // Strings are inserted in the middle, so neither version only appends.
+    const unsigned long single = strqueue_new();
+    const unsigned long bulk = strqueue_new();
+    const double insert_at = nanoseconds_per_element(number_of_strings, [&] {
+        for (std::size_t i = 0; i < number_of_strings; i++)
+            strqueue_insert_at(single, i / 2, strs[i]);
+    });
+    const double insert_many = nanoseconds_per_element(number_of_strings, [&] {
+        for (std::size_t first = 0; first < number_of_strings; first += batch_size)
+            strqueue_insert_many(bulk, first / 2, strs.data() + first, std::min(batch_size, number_of_strings - first));
+    });
+
+    const double get_at = nanoseconds_per_element(number_of_strings, [&] {
+        for (std::size_t i = 0; i < number_of_strings; i++)
+            read[i] = strqueue_get_at(single, i);
+    });
+    const double get_range = nanoseconds_per_element(number_of_strings, [&] {
+        for (std::size_t first = 0; first < number_of_strings; first += batch_size)
+            strqueue_get_range(bulk, first, batch_size, read.data() + first);
+    });
+
+    // Strings are removed from the middle of what is left.
+    const double remove_at = nanoseconds_per_element(number_of_strings, [&] {
+        for (std::size_t left = number_of_strings; left > 0; left--)
+            strqueue_remove_at(single, left / 2);
+    });
+    const double remove_range = nanoseconds_per_element(number_of_strings, [&] {
+        for (std::size_t left = number_of_strings; left > 0; left -= std::min(batch_size, left))
+            strqueue_remove_range(bulk, (left - std::min(batch_size, left)) / 2, std::min(batch_size, left));
+    });
+
+    std::printf("%zu strings, batches of %zu, time per element\n", number_of_strings, batch_size);
+    report("strqueue_insert_at", insert_at, "strqueue_insert_many", insert_many);
+    report("strqueue_get_at", get_at, "strqueue_get_range", get_range);
+    report("strqueue_remove_at", remove_at, "strqueue_remove_range", remove_range);
+
+    const bool is_empty = strqueue_size(single) == 0 && strqueue_size(bulk) == 0;
+    strqueue_delete(single);
+    strqueue_delete(bulk);
+    return is_empty ? 0 : 1;
+}
@@ -0,0 +1,19 @@
+#!/bin/sh
+# Compares bulk functions of strqueue with loops of single element calls, in the debug build, whose trace
+# is discarded, and in the build with NDEBUG.
+# Usage: bench/bulk_benchmark.sh [number_of_strings [batch_size]]
+set -eu
+
+cd "$(dirname "$0")/.."
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++20 -O2}
+$CXX $CXXFLAGS bench/bulk_benchmark.cpp strqueue.cpp -o "$work/bulk_debug"
+$CXX $CXXFLAGS -DNDEBUG bench/bulk_benchmark.cpp strqueue.cpp -o "$work/bulk_benchmark"
+
+echo "Debug build:"
+"$work/bulk_debug" "$@" 2> /dev/null
+echo "Build with NDEBUG:"
+"$work/bulk_benchmark" "$@"
@@ -0,0 +1,95 @@
+// Benchmark of strqueue_clone, which shares strings and chunks with the cloned queue, against a naive copy
+// made by reading all strings and inserting them into a new queue. Each copy of a large queue gets a few
+// changes, then memory added by copies and time of copying and of the changes are reported.
+// Build: g++ -std=c++20 -O2 -DNDEBUG bench/clone_benchmark.cpp strqueue.cpp
+// Usage: clone_benchmark [queue_size [number_of_copies [changes_per_copy]]]
+
+#include "../strqueue.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+    using namespace cxx;
+
+    // Function returns current resident set size in MiB.
+    double resident_size() {
+        std::ifstream statm("/proc/self/statm");
+        std::size_t total_pages = 0, resident_pages = 0;
+        statm >> total_pages >> resident_pages;
+        return static_cast<double>(resident_pages) * sysconf(_SC_PAGESIZE) / 1048576;
+    }
+
+    double seconds_since(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    unsigned long naive_copy(unsigned long id) {
+        std::vector<const char *> strs(strqueue_size(id));
+        strqueue_get_range(id, 0, strs.size(), strs.data());
+        const unsigned long copy = strqueue_new();
+        strqueue_insert_many(copy, 0, strs.data(), strs.size());
+        return copy;
+    }
+
+    // Function makes copies of source with given function, changes them and prints the results.
+    template <typename Copy>
+    void measure(const char *name, unsigned long source, std::size_t copies_count, std::size_t changes,
+                 const Copy &copy) {
+        const std::size_t size = strqueue_size(source);
+        const double memory_before = resident_size();
+        std::vector<unsigned long> copies;
+        double copying_time = 0, changing_time = 0;
+        for (std::size_t i = 0; i < copies_count; i++) {
+            auto start = std::chrono::steady_clock::now();
+            copies.push_back(copy(source));
+            copying_time += seconds_since(start);
+
+            start = std::chrono::steady_clock::now();
+            for (std::size_t change = 0; change < changes; change++) {
+                const std::size_t position = (i * 104729 + change * 7919) % size;
+                strqueue_remove_at(copies.back(), position);
+                strqueue_insert_at(copies.back(), position, "changed");
+            }
+            changing_time += seconds_since(start);
+        }
+        std::printf("%-12s copy %9.3f ms, changes %9.3f ms, added memory %8.1f MiB\n", name,
+                    copying_time * 1000 / copies_count, changing_time * 1000 / copies_count,
+                    resident_size() - memory_before);
+
+        for (unsigned long id : copies)
+            strqueue_delete(id);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const std::size_t queue_size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const std::size_t copies = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20;
+    const std::size_t changes = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 10;
+    if (queue_size == 0 || copies == 0) {
+        std::fprintf(stderr, "Queue and number of copies can't be empty.\n");
+        return 1;
+    }
+
+    std::vector<std::string> strings(queue_size);
+    std::vector<const char *> strs(queue_size);
+    for (std::size_t i = 0; i < queue_size; i++) {
+        strings[i] = "string number " + std::to_string(i);
+        strs[i] = strings[i].c_str();
+    }
+    const unsigned long source = strqueue_new();
+    strqueue_insert_many(source, 0, strs.data(), queue_size);
+
+    std::printf("%zu strings, %zu copies with %zu changes each, times per copy\n", queue_size, copies, changes);
+    // Clones are measured first, so memory freed by naive copies and kept by allocator doesn't hide theirs.
+    measure("clone", source, copies, changes, strqueue_clone);
+    measure("naive copy", source, copies, changes, naive_copy);
+    strqueue_delete(source);
+    return 0;
+}
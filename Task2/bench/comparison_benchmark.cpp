@@ -0,0 +1,69 @@
+// Benchmark of strqueue_comp and strqueue_equal on long queues: equal ones, ones differing only in the last
+// string, in the middle one or in size. Build it with and without STRQUEUE_CONTENT_HASH, see
+// comparison_benchmark.sh; hashes speed up only strqueue_equal of queues that differ.
+// Usage: comparison_benchmark [queue_size [calls]]
+
+#include "../strqueue.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+    using namespace cxx;
+
+    unsigned long make_queue(std::size_t size) {
+        const unsigned long id = strqueue_new();
+        for (std::size_t i = 0; i < size; i++)
+            strqueue_insert_at(id, i, ("string number " + std::to_string(i)).c_str());
+        return id;
+    }
+
+    unsigned long changed_at(std::size_t size, std::size_t position) {
+        const unsigned long id = make_queue(size);
+        strqueue_remove_at(id, position);
+        strqueue_insert_at(id, position, "changed string");
+        return id;
+    }
+
+    // Results are stored, so calls aren't removed.
+    volatile int result;
+
+    template <typename Function>
+    double microseconds_per_call(std::size_t calls, Function function) {
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t call = 0; call < calls; call++)
+            result = function();
+        const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / calls;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const std::size_t queue_size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    const std::size_t calls = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20;
+    if (queue_size < 2 || calls == 0) {
+        std::fprintf(stderr, "Queues need at least two strings and there has to be at least one call.\n");
+        return 1;
+    }
+
+    const unsigned long queue = make_queue(queue_size);
+    const struct {
+        const char *name;
+        unsigned long other;
+    } cases[] = {
+        {"equal", make_queue(queue_size)},
+        {"last string differs", changed_at(queue_size, queue_size - 1)},
+        {"middle string differs", changed_at(queue_size, queue_size / 2)},
+        {"one string shorter", make_queue(queue_size - 1)},
+    };
+
+    std::printf("queues of %zu strings, time per call\n", queue_size);
+    for (const auto &[name, other] : cases) {
+        const double comp = microseconds_per_call(calls, [&] { return strqueue_comp(queue, other); });
+        const double equal = microseconds_per_call(calls, [&] { return strqueue_equal(queue, other); });
+        std::printf("%-22s strqueue_comp %10.2f us   strqueue_equal %10.2f us\n", name, comp, equal);
+    }
+    return 0;
+}
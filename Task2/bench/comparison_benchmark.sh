@@ -0,0 +1,18 @@
+#!/bin/sh
+# Compares strqueue_comp and strqueue_equal on long queues built with and without content hashes.
+# Usage: bench/comparison_benchmark.sh [queue_size [calls]]
+set -eu
+
+cd "$(dirname "$0")/.."
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++20 -O2 -DNDEBUG}
+$CXX $CXXFLAGS bench/comparison_benchmark.cpp strqueue.cpp -o "$work/comparison_benchmark"
+$CXX $CXXFLAGS -DSTRQUEUE_CONTENT_HASH bench/comparison_benchmark.cpp strqueue.cpp -o "$work/comparison_hash"
+
+echo "Without content hashes:"
+"$work/comparison_benchmark" "$@"
+echo "With STRQUEUE_CONTENT_HASH:"
+"$work/comparison_hash" "$@"
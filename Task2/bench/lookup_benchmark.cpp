@@ -0,0 +1,52 @@
+// Benchmark of finding queues by their ids: strqueue_size and strqueue_get_at are called on random queues out
+// of many live ones, while some queues are deleted and created again, so ids keep changing. Uses only functions
+// available since the first version of strqueue, so it can be linked with any of them, see lookup_benchmark.sh.
+// Usage: lookup_benchmark [number_of_queues [number_of_lookups [lookups_per_change]]]
+
+#include "strqueue.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+int main(int argc, char *argv[]) {
+    using namespace cxx;
+
+    const std::size_t number_of_queues = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    const std::size_t number_of_lookups = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20000000;
+    const std::size_t lookups_per_change = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 64;
+    if (number_of_queues == 0 || lookups_per_change == 0) {
+        std::fprintf(stderr, "There has to be at least one queue and one lookup per change.\n");
+        return 1;
+    }
+
+    // Every queue holds one string, so every lookup finds something to read.
+    std::vector<unsigned long> queues(number_of_queues);
+    for (unsigned long &id : queues) {
+        id = strqueue_new();
+        strqueue_insert_at(id, 0, "string");
+    }
+
+    std::mt19937_64 generator(1);
+    std::size_t found = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t lookup = 0; lookup < number_of_lookups; lookup++) {
+        unsigned long &id = queues[generator() % number_of_queues];
+        if (lookup % lookups_per_change == 0) {
+            strqueue_delete(id);
+            id = strqueue_new();
+            strqueue_insert_at(id, 0, "string");
+        }
+        found += strqueue_size(id);
+        found += strqueue_get_at(id, 0) != nullptr;
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("%zu queues, %zu lookups, one queue replaced every %zu lookups: %.1f ns per lookup\n",
+                number_of_queues, number_of_lookups, lookups_per_change, elapsed.count() / number_of_lookups);
+    for (unsigned long id : queues)
+        strqueue_delete(id);
+    return found != 2 * number_of_lookups;
+}
@@ -0,0 +1,24 @@
+#!/bin/sh
+# Compares finding queues by ids in strqueue with its first version taken from the root commit,
+# which kept queues in std::unordered_map, while queues are deleted and created again.
+# Usage: bench/lookup_benchmark.sh [number_of_queues [number_of_lookups [lookups_per_change]]]
+set -eu
+
+cd "$(dirname "$0")/.."
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+baseline=$(git rev-list --max-parents=0 HEAD)
+mkdir "$work/baseline"
+git show "$baseline:Task2/strqueue.cpp" > "$work/baseline/strqueue.cpp"
+git show "$baseline:Task2/strqueue.h" > "$work/baseline/strqueue.h"
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++20 -O2 -DNDEBUG}
+$CXX $CXXFLAGS -I"$work/baseline" bench/lookup_benchmark.cpp "$work/baseline/strqueue.cpp" -o "$work/lookup_baseline"
+$CXX $CXXFLAGS -I. bench/lookup_benchmark.cpp strqueue.cpp -o "$work/lookup_benchmark"
+
+echo "First version:"
+"$work/lookup_baseline" "$@"
+echo "Current version:"
+"$work/lookup_benchmark" "$@"
@@ -0,0 +1,24 @@
+#!/bin/sh
+# Compares allocations and peak memory of strqueue with its first version taken from the root commit,
+# which kept each string in its own std::string.
+# Usage: bench/memory_benchmark.sh [number_of_strings [number_of_queues [string_length]]]
+set -eu
+
+cd "$(dirname "$0")/.."
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+baseline=$(git rev-list --max-parents=0 HEAD)
+mkdir "$work/baseline"
+git show "$baseline:Task2/strqueue.cpp" > "$work/baseline/strqueue.cpp"
+git show "$baseline:Task2/strqueue.h" > "$work/baseline/strqueue.h"
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++20 -O2 -DNDEBUG}
+$CXX $CXXFLAGS -I"$work/baseline" bench/memory_usage.cpp "$work/baseline/strqueue.cpp" -o "$work/memory_baseline"
+$CXX $CXXFLAGS -I. bench/memory_usage.cpp strqueue.cpp -o "$work/memory_usage"
+
+echo "First version:"
+"$work/memory_baseline" "$@"
+echo "Current version:"
+"$work/memory_usage" "$@"
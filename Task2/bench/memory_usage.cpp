@@ -0,0 +1,89 @@
+// Benchmark of memory used by strqueue for many short strings. Counts allocations made through operator new
+// and reports peak resident set size. Uses only functions available since the first version of strqueue,
+// so it can be linked with any of them, see memory_benchmark.sh.
+// Usage: memory_usage [number_of_strings [number_of_queues [string_length]]]
+
+#include "strqueue.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+namespace {
+    std::size_t allocations = 0;
+    std::size_t allocated_bytes = 0;
+}
+
+void *operator new(std::size_t size) {
+    allocations++;
+    allocated_bytes += size;
+    if (void *memory = std::malloc(size == 0 ? 1 : size))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+int main(int argc, char *argv[]) {
+    using namespace cxx;
+
+    const std::size_t number_of_strings = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5000000;
+    const std::size_t number_of_queues = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16;
+    // Default length is just above what fits into std::string without allocation.
+    const int string_length = argc > 3 ? std::atoi(argv[3]) : 24;
+    if (number_of_queues == 0 || string_length < 8 || string_length > 255) {
+        std::fprintf(stderr, "There has to be at least one queue and strings have 8 to 255 characters.\n");
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<unsigned long> queues;
+    for (std::size_t i = 0; i < number_of_queues; i++)
+        queues.push_back(strqueue_new());
+
+    // Strings are keys made of a letter and a number padded with zeros.
+    char str[256];
+    for (std::size_t i = 0; i < number_of_strings; i++) {
+        std::snprintf(str, sizeof(str), "k%0*zu", string_length - 1, i);
+        strqueue_insert_at(queues[i % number_of_queues], i, str);
+    }
+    const std::size_t allocations_after_insertion = allocations;
+
+    // Half of strings are removed from front and replaced at the end, so space of removed strings can be reused.
+    for (unsigned long id : queues) {
+        const std::size_t size = strqueue_size(id);
+        for (std::size_t i = 0; i < size / 2; i++) {
+            strqueue_remove_at(id, 0);
+            strqueue_insert_at(id, size, str);
+        }
+    }
+
+    std::size_t checked_length = 0;
+    for (unsigned long id : queues)
+        for (std::size_t position = 0; position < strqueue_size(id); position += 1000)
+            checked_length += std::string(strqueue_get_at(id, position)).size();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::printf("%zu strings of length %d in %zu queues: %.2f s\n", number_of_strings, string_length,
+                number_of_queues, elapsed.count());
+    std::printf("allocations: %zu while inserting, %zu in total (%.1f MiB requested)\n",
+                allocations_after_insertion, allocations, allocated_bytes / 1048576.0);
+    std::printf("peak RSS: %.1f MiB\n", usage.ru_maxrss / 1024.0);
+
+    for (unsigned long id : queues)
+        strqueue_delete(id);
+    return checked_length == 0;
+}
@@ -0,0 +1,74 @@
+// Throughput benchmark of strqueue built with STRQUEUE_THREAD_SAFE. For every number of threads from 1 to given
+// maximum, threads change and read their own queues and then all of them use a few shared queues,
+// so the first part shows scaling of independent operations and the second one contention on slot locks.
+// Build: g++ -std=c++20 -O2 -DNDEBUG -DSTRQUEUE_THREAD_SAFE -pthread bench/thread_throughput.cpp strqueue.cpp
+// Usage: thread_throughput [max_threads [operations_per_thread]]
+
+#include "../strqueue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+    using namespace cxx;
+
+    constexpr std::size_t SHARED_COUNT = 4;
+
+    // Each operation inserts, reads and removes a string, compares two queues and sometimes clones one.
+    void run_operations(unsigned long queue, unsigned long other, std::size_t operations) {
+        for (std::size_t operation = 0; operation < operations; operation++) {
+            strqueue_insert_at(queue, operation % 64, "benchmark string");
+            strqueue_get_at(queue, operation % 32);
+            if (strqueue_size(queue) > 64)
+                strqueue_remove_at(queue, 0);
+            strqueue_comp(queue, other);
+            if (operation % 256 == 0)
+                strqueue_delete(strqueue_clone(queue));
+        }
+    }
+
+    // Function returns millions of operations done in a second by given number of threads.
+    template <typename Function>
+    double measure(std::size_t number_of_threads, std::size_t operations, const Function &function) {
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (std::size_t thread = 0; thread < number_of_threads; thread++)
+            threads.emplace_back(function, thread);
+        for (auto &thread : threads)
+            thread.join();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return number_of_threads * operations / elapsed.count() / 1e6;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const std::size_t max_threads = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                                             : std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t operations = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200000;
+
+    std::vector<unsigned long> shared;
+    for (std::size_t i = 0; i < SHARED_COUNT; i++)
+        shared.push_back(strqueue_new());
+
+    std::printf("threads  own queues [Mop/s]  shared queues [Mop/s]\n");
+    for (std::size_t number_of_threads = 1; number_of_threads <= max_threads; number_of_threads++) {
+        const double own = measure(number_of_threads, operations, [&](std::size_t) {
+            const unsigned long queue = strqueue_new(), other = strqueue_new();
+            run_operations(queue, other, operations);
+            strqueue_delete(queue);
+            strqueue_delete(other);
+        });
+        const double contended = measure(number_of_threads, operations, [&](std::size_t thread) {
+            run_operations(shared[thread % SHARED_COUNT], shared[(thread + 1) % SHARED_COUNT], operations);
+        });
+        std::printf("%7zu  %18.2f  %21.2f\n", number_of_threads, own, contended);
+    }
+
+    for (unsigned long id : shared)
+        strqueue_delete(id);
+    return 0;
+}
@@ -1,134 +1,2038 @@
 #include "strqueue.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <compare>
 #include <cstddef>
-#include <deque>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <span>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #ifdef NDEBUG
 constexpr bool debug = false;
 #else
 constexpr bool debug = true;
 #endif
 
-namespace cxx {
-    using Id_t = unsigned long;
-    using Map_t = std::unordered_map<Id_t, std::deque<std::string> >;
+// Build with STRQUEUE_THREAD_SAFE defined to allow calling functions from many threads at once.
+#ifdef STRQUEUE_THREAD_SAFE
+constexpr bool thread_safe = true;
+#else
+constexpr bool thread_safe = false;
+#endif
+
+// Build with STRQUEUE_SYNC_TRACE defined to print debug trace of every call at once instead of buffering it.
+#ifdef STRQUEUE_SYNC_TRACE
+constexpr bool sync_trace = true;
+#else
+constexpr bool sync_trace = false;
+#endif
+
+// Build with STRQUEUE_CONTENT_HASH defined to keep hashes of queue contents. strqueue_equal then knows queues
+// with different hashes differ without reading their strings; equal hashes are always confirmed by comparing
+// strings. Hashes speed up only strqueue_equal, strqueue_comp always compares strings up to the first difference.
+#ifdef STRQUEUE_CONTENT_HASH
+constexpr bool content_hash = true;
+#else
+constexpr bool content_hash = false;
+#endif
+
+namespace cxx {
+    using Id_t = unsigned long;
+
+    // Polynomial hashes modulo prime 2^61 - 1. Bases are chosen at random when program starts,
+    // so no input makes hashes of different sequences equal more often than others.
+    constexpr std::uint64_t HASH_MODULUS = (std::uint64_t{1} << 61) - 1;
+
+    __extension__ using Uint128_t = unsigned __int128;
+
+    static std::uint64_t hash_add(std::uint64_t a, std::uint64_t b) {
+        const std::uint64_t sum = a + b;
+        return sum >= HASH_MODULUS ? sum - HASH_MODULUS : sum;
+    }
+
+    static std::uint64_t hash_multiply(std::uint64_t a, std::uint64_t b) {
+        const Uint128_t product = static_cast<Uint128_t>(a) * b;
+        const std::uint64_t folded = static_cast<std::uint64_t>(product & HASH_MODULUS) +
+                                     static_cast<std::uint64_t>(product >> 61);
+        return hash_add(folded & HASH_MODULUS, folded >> 61);
+    }
+
+    // Function returns hash of sequence hashed so far followed by sequence with given hash and power.
+    static std::uint64_t hash_append(std::uint64_t hash, std::uint64_t appended_hash, std::uint64_t appended_power) {
+        return hash_add(hash_multiply(hash, appended_power), appended_hash);
+    }
+
+    static std::uint64_t random_hash_base() {
+        std::random_device device;
+        const std::uint64_t random = (std::uint64_t{device()} << 32) | device();
+        return random % (HASH_MODULUS - 2) + 2;
+    }
+
+    // Base of hashes of strings. Queues restored from journal use the base their hashes were computed with.
+    static std::uint64_t &string_hash_base() {
+        static std::uint64_t base = random_hash_base();
+        return base;
+    }
+
+    // Base of hashes of sequences of strings.
+    static std::uint64_t sequence_hash_base() {
+        static const std::uint64_t base = random_hash_base();
+        return base;
+    }
+
+    // Function hashes length of string and its bytes, taken in groups of four.
+    static std::uint64_t string_hash(const char *str, std::size_t length) {
+        const std::uint64_t base = string_hash_base();
+        std::uint64_t hash = length % HASH_MODULUS;
+        for (std::size_t i = 0; i < length; i += 4) {
+            std::uint32_t word = 0;
+            std::memcpy(&word, str + i, std::min<std::size_t>(4, length - i));
+            hash = hash_add(hash_multiply(hash, base), word);
+        }
+        return hash;
+    }
+
+    // Base of objects shared by many queues, which counts pointers to the object.
+    struct Shared_t {
+        Shared_t() = default;
+        // Copy of object is a new object, so no pointers refer to it yet.
+        Shared_t(const Shared_t &) {}
+        Shared_t &operator=(const Shared_t &) = delete;
+
+        std::atomic<std::size_t> references{0};
+    };
+
+    // Pointer to shared object, which deletes the object when the last pointer to it is gone.
+    template <typename T>
+    class Shared_ptr_t {
+    public:
+        Shared_ptr_t() = default;
+
+        Shared_ptr_t(std::nullptr_t) {}
+
+        explicit Shared_ptr_t(T *object) : object(object) {
+            acquire();
+        }
+
+        Shared_ptr_t(const Shared_ptr_t &other) : object(other.object) {
+            acquire();
+        }
+
+        Shared_ptr_t(Shared_ptr_t &&other) noexcept : object(std::exchange(other.object, nullptr)) {}
+
+        Shared_ptr_t &operator=(Shared_ptr_t other) noexcept {
+            std::swap(object, other.object);
+            return *this;
+        }
+
+        ~Shared_ptr_t() {
+            if (object != nullptr && object->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                delete object;
+        }
+
+        T *get() const {
+            return object;
+        }
+
+        T &operator*() const {
+            return *object;
+        }
+
+        T *operator->() const {
+            return object;
+        }
+
+        bool operator==(std::nullptr_t) const {
+            return object == nullptr;
+        }
+
+        // Function tells if no other pointer refers to the object. Then changes made to it through other pointers
+        // before they were gone are visible and the object can be changed.
+        bool is_unique() const {
+            return object->references.load(std::memory_order_acquire) == 1;
+        }
+
+        void reset() {
+            *this = nullptr;
+        }
+
+    private:
+        void acquire() {
+            if (object != nullptr)
+                object->references.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        T *object = nullptr;
+    };
+
+    template <typename T, typename... Arguments>
+    static Shared_ptr_t<T> make_shared_object(Arguments &&... arguments) {
+        return Shared_ptr_t<T>(new T(std::forward<Arguments>(arguments)...));
+    }
+
+    // Storage of strings of one queue. Each string is kept after its length (and hash when content hashes
+    // are kept), short ones in shared pages and long ones in separate allocations. Space of removed short
+    // strings is reused by strings of the same size class, so pointers to kept strings never change.
+    // Strings stored before queue was cloned are sealed: they are shared with the clone and their space is
+    // freed only when neither of the queues can use it.
+    class String_store_t {
+    public:
+        String_store_t() = default;
+        String_store_t(const String_store_t &) = delete;
+        String_store_t &operator=(const String_store_t &) = delete;
+
+        static std::size_t length(const char *str) {
+            std::size_t length;
+            std::memcpy(&length, str - sizeof(std::size_t), sizeof(std::size_t));
+            return length;
+        }
+
+        static std::string_view view(const char *str) {
+            return std::string_view(str, length(str));
+        }
+
+        static std::uint64_t hash(const char *str) {
+            std::uint64_t hash;
+            std::memcpy(&hash, str - 2 * sizeof(std::size_t), sizeof(std::uint64_t));
+            return hash;
+        }
+
+        static std::size_t entry_size(std::size_t length) {
+            return round_up(HEADER_SIZE + length + 1);
+        }
+
+        // Function returns string whose entry follows entry of given string.
+        static const char *next(const char *str) {
+            return str + entry_size(length(str));
+        }
+
+        // Function writes entry of string at given place and returns pointer to the copy of string.
+        static const char *write_entry(char *entry, const char *str, std::size_t length) {
+            if constexpr (content_hash) {
+                const std::uint64_t hash = string_hash(str, length);
+                std::memcpy(entry, &hash, sizeof(std::uint64_t));
+            }
+            std::memcpy(entry + HEADER_SIZE - sizeof(std::size_t), &length, sizeof(std::size_t));
+            std::memcpy(entry + HEADER_SIZE, str, length + 1);
+            return entry + HEADER_SIZE;
+        }
+
+        // Function makes sure that short strings with given total size of entries fit into the last page.
+        void reserve(std::size_t entries_size) {
+            if (pages.empty() || last_page_size - used_in_last_page < entries_size)
+                add_page(std::max(next_page_size(), entries_size));
+        }
+
+        // Function copies string to the store and returns pointer to the copy.
+        const char *insert(const char *str) {
+            return insert(str, std::strlen(str));
+        }
+
+        const char *insert(const char *str, std::size_t length) {
+            const std::size_t entry_size = String_store_t::entry_size(length);
+            char *entry;
+
+            if (entry_size > LARGE_ENTRY) {
+                auto allocation = std::make_unique<char[]>(entry_size);
+                entry = allocation.get();
+                large_entries.emplace(entry, std::move(allocation));
+            } else if (free_entries != nullptr && (*free_entries)[entry_size / ALIGNMENT] != nullptr) {
+                entry = (*free_entries)[entry_size / ALIGNMENT];
+                std::memcpy(&(*free_entries)[entry_size / ALIGNMENT], entry + HEADER_SIZE, sizeof(char *));
+            } else {
+                if (pages.empty() || last_page_size - used_in_last_page < entry_size)
+                    add_page(std::max(next_page_size(), entry_size));
+                entry = last_page + used_in_last_page;
+                used_in_last_page += entry_size;
+            }
+
+            return write_entry(entry, str, length);
+        }
+
+        // Function frees space of string returned by insert, unless the string is sealed.
+        void erase(const char *str) {
+            char *entry = const_cast<char *>(str) - HEADER_SIZE;
+            const std::size_t entry_size = String_store_t::entry_size(length(str));
+
+            if (entry_size > LARGE_ENTRY) {
+                large_entries.erase(entry);
+                return;
+            }
+
+            if (sealed != nullptr && !is_in_pages(entry))
+                return;
+
+            // Removed entries of one size class form a list linked through their first bytes after header.
+            // Lists are allocated on first removal, so stores of queues that only grow stay small.
+            if (free_entries == nullptr)
+                free_entries = std::make_unique<Free_entries_t>();
+            std::memcpy(entry + HEADER_SIZE, &(*free_entries)[entry_size / ALIGNMENT], sizeof(char *));
+            (*free_entries)[entry_size / ALIGNMENT] = entry;
+        }
+
+        // Function frees all strings in time proportional to number of pages.
+        void clear() {
+            pages.clear();
+            page_sizes.clear();
+            large_entries.clear();
+            sealed.reset();
+            free_entries.reset();
+            last_page = nullptr;
+            used_in_last_page = 0;
+            last_page_size = 0;
+        }
+
+        // Function seals all strings and makes clone, which has to be empty, share them.
+        void share(String_store_t &clone) {
+            if (!pages.empty() || !large_entries.empty()) {
+                auto sealing = make_shared_object<Sealed_t>();
+                sealing->pages = std::move(pages);
+                sealing->large_entries = std::move(large_entries);
+                sealing->previous = std::move(sealed);
+                sealed = std::move(sealing);
+
+                // Free space in sealed pages could be taken by both stores.
+                pages.clear();
+                page_sizes.clear();
+                large_entries.clear();
+                free_entries.reset();
+                last_page = nullptr;
+                used_in_last_page = 0;
+                last_page_size = 0;
+            }
+            clone.sealed = sealed;
+        }
+
+        static constexpr std::size_t LARGE_ENTRY = 1 << 10;
+        static constexpr std::size_t ALIGNMENT = alignof(std::size_t);
+        static constexpr std::size_t HEADER_SIZE = content_hash ? 2 * sizeof(std::size_t) : sizeof(std::size_t);
+
+    private:
+        static constexpr std::size_t MIN_PAGE_SIZE = 1 << 8;
+        static constexpr std::size_t PAGE_SIZE = 1 << 16;
+
+        // Strings sealed by one clone and, through previous, by earlier ones.
+        struct Sealed_t : Shared_t {
+            ~Sealed_t() {
+                // Long chains are released in a loop instead of recursion.
+                Shared_ptr_t<Sealed_t> next = std::move(previous);
+                while (next != nullptr && next.is_unique())
+                    next = std::move(next->previous);
+            }
+
+            std::vector<std::unique_ptr<char[]>> pages;
+            std::unordered_map<const char *, std::unique_ptr<char[]>> large_entries;
+            Shared_ptr_t<Sealed_t> previous;
+        };
+
+        // Pages start small, so stores of short queues and of clones which change little stay small.
+        std::size_t next_page_size() const {
+            return std::clamp(2 * last_page_size, MIN_PAGE_SIZE, PAGE_SIZE);
+        }
+
+        void add_page(std::size_t page_size) {
+            auto page = std::make_unique_for_overwrite<char[]>(page_size);
+            last_page = page.get();
+            pages.push_back(std::move(page));
+            page_sizes.emplace(last_page, page_size);
+            used_in_last_page = 0;
+            last_page_size = page_size;
+        }
+
+        bool is_in_pages(const char *entry) const {
+            auto page = page_sizes.upper_bound(entry);
+            if (page == page_sizes.begin())
+                return false;
+            --page;
+            return entry < page->first + page->second;
+        }
+
+        static std::size_t round_up(std::size_t size) {
+            return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        }
+
+        std::vector<std::unique_ptr<char[]>> pages;
+        // Sizes of pages ordered by their addresses.
+        std::map<const char *, std::size_t> page_sizes;
+        char *last_page = nullptr;
+        std::size_t used_in_last_page = 0;
+        std::size_t last_page_size = 0;
+        using Free_entries_t = std::array<char *, LARGE_ENTRY / ALIGNMENT + 1>;
+        std::unique_ptr<Free_entries_t> free_entries;
+        std::unordered_map<const char *, std::unique_ptr<char[]>> large_entries;
+        Shared_ptr_t<Sealed_t> sealed;
+    };
+
+    // Sequence of strings kept in chunks, which are nodes of a treap ordered by position.
+    // Inserting, removing and accessing element at any position takes expected O(log n) time.
+    // Copies of sequence share nodes, which are copied by sequence that changes them.
+    class Sequence_t {
+        static constexpr std::uint32_t CHUNK_CAPACITY = 64;
+
+        struct Node_t;
+        using Node_ptr = Shared_ptr_t<Node_t>;
+
+        struct Node_t : Shared_t {
+            std::uint32_t priority;
+            // Number of elements in this chunk and in whole subtree.
+            std::uint32_t count = 0;
+            std::size_t size = 0;
+            // Hashes of sequences of strings in this chunk and in whole subtree, kept only with content hashes,
+            // and powers of base to their lengths.
+            std::uint64_t chunk_hash = 0, chunk_power = 1;
+            std::uint64_t hash = 0, power = 1;
+            Node_ptr left, right;
+            std::array<const char *, CHUNK_CAPACITY> elements;
+        };
+
+    public:
+        // Iterator visiting elements in order of their positions.
+        class const_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = const char *;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const char *const *;
+            using reference = const char *const &;
+
+            const_iterator() = default;
+
+            explicit const_iterator(const Node_t *root) {
+                push_left(root);
+            }
+
+            const_iterator(const Node_t *node, std::size_t position) {
+                while (node != nullptr) {
+                    const std::size_t left_size = size_of(node->left);
+                    if (position < left_size) {
+                        path.push_back(node);
+                        node = node->left.get();
+                    } else if (position < left_size + node->count) {
+                        path.push_back(node);
+                        index = position - left_size;
+                        return;
+                    } else {
+                        position -= left_size + node->count;
+                        node = node->right.get();
+                    }
+                }
+            }
+
+            reference operator*() const {
+                return path.back()->elements[index];
+            }
+
+            const_iterator &operator++() {
+                if (++index < path.back()->count)
+                    return *this;
+
+                const Node_t *visited = path.back();
+                path.pop_back();
+                index = 0;
+                push_left(visited->right.get());
+                return *this;
+            }
+
+            const_iterator operator++(int) {
+                const_iterator previous = *this;
+                ++*this;
+                return previous;
+            }
+
+            bool operator==(const const_iterator &other) const {
+                if (path.empty() || other.path.empty())
+                    return path.empty() == other.path.empty();
+                return path.back() == other.path.back() && index == other.index;
+            }
+
+        private:
+            void push_left(const Node_t *node) {
+                for (; node != nullptr; node = node->left.get())
+                    path.push_back(node);
+            }
+
+            // Nodes whose chunks are not visited yet, the last one is current.
+            std::vector<const Node_t *> path;
+            std::uint32_t index = 0;
+        };
+
+        std::size_t size() const {
+            return size_of(root);
+        }
+
+        bool empty() const {
+            return root == nullptr;
+        }
+
+        const_iterator begin() const {
+            return const_iterator(root.get());
+        }
+
+        const_iterator end() const {
+            return const_iterator();
+        }
+
+        // Function returns iterator to element at given position, which has to be at most equal to size.
+        const_iterator iterator_at(std::size_t position) const {
+            return const_iterator(root.get(), position);
+        }
+
+        const char *at(std::size_t position) const {
+            const Node_t *node = root.get();
+            while (true) {
+                const std::size_t left_size = size_of(node->left);
+                if (position < left_size) {
+                    node = node->left.get();
+                } else if (position < left_size + node->count) {
+                    return node->elements[position - left_size];
+                } else {
+                    position -= left_size + node->count;
+                    node = node->right.get();
+                }
+            }
+        }
+
+        std::uint64_t hash() const {
+            return hash_of(root);
+        }
+
+        // Position has to be at most equal to size.
+        void insert(std::size_t position, const char *str) {
+            root = insert(std::move(root), position, str);
+        }
+
+        // Function inserts count strings before position, which has to be at most equal to size.
+        // New elements are put into full chunks and joined with the rest of sequence at once.
+        void insert(std::size_t position, const char *const *strs, std::size_t count) {
+            Node_ptr inserted;
+            for (std::size_t first = 0; first < count; first += CHUNK_CAPACITY) {
+                Node_ptr node = new_node();
+                node->count = std::min<std::size_t>(CHUNK_CAPACITY, count - first);
+                std::copy(strs + first, strs + first + node->count, node->elements.begin());
+                update_chunk(*node);
+                update(*node);
+                inserted = merge(std::move(inserted), std::move(node));
+            }
+
+            auto [before, after] = split(std::move(root), position);
+            root = merge(merge(std::move(before), std::move(inserted)), std::move(after));
+        }
+
+        // Function removes at most count elements starting from position and calls erased for each of them.
+        template <typename Function>
+        void erase(std::size_t position, std::size_t count, const Function &erased) {
+            auto [before, rest] = split(std::move(root), position);
+            auto [removed, after] = split(std::move(rest), count);
+            for (auto str = const_iterator(removed.get()); str != const_iterator(); ++str)
+                erased(*str);
+            root = merge(std::move(before), std::move(after));
+        }
+
+        // Function removes element at existing position and returns it.
+        const char *erase(std::size_t position) {
+            const char *erased = nullptr;
+            root = erase(std::move(root), position, erased);
+            return erased;
+        }
+
+        void clear() {
+            root.reset();
+        }
+
+    private:
+        static std::size_t size_of(const Node_ptr &node) {
+            return node == nullptr ? 0 : node->size;
+        }
+
+        static std::uint64_t hash_of(const Node_ptr &node) {
+            return node == nullptr ? 0 : node->hash;
+        }
+
+        static std::uint64_t power_of(const Node_ptr &node) {
+            return node == nullptr ? 1 : node->power;
+        }
+
+        static void update(Node_t &node) {
+            node.size = size_of(node.left) + node.count + size_of(node.right);
+            if constexpr (content_hash) {
+                node.hash = hash_append(hash_append(hash_of(node.left), node.chunk_hash, node.chunk_power),
+                                        hash_of(node.right), power_of(node.right));
+                node.power = hash_multiply(hash_multiply(power_of(node.left), node.chunk_power), power_of(node.right));
+            }
+        }
+
+        // Function recomputes hash of chunk after its elements have changed.
+        static void update_chunk(Node_t &node) {
+            if constexpr (content_hash) {
+                const std::uint64_t base = sequence_hash_base();
+                node.chunk_hash = 0;
+                node.chunk_power = 1;
+                for (std::uint32_t i = 0; i < node.count; i++) {
+                    node.chunk_hash = hash_append(node.chunk_hash, String_store_t::hash(node.elements[i]), base);
+                    node.chunk_power = hash_multiply(node.chunk_power, base);
+                }
+            }
+        }
+
+        static std::uint32_t random_priority() {
+            static thread_local std::uint32_t state = 2463534242u;
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+
+        static Node_ptr new_node() {
+            Node_ptr node = make_shared_object<Node_t>();
+            node->priority = random_priority();
+            return node;
+        }
+
+        static void insert_into_chunk(Node_t &node, std::uint32_t index, const char *str) {
+            std::copy_backward(node.elements.begin() + index, node.elements.begin() + node.count,
+                               node.elements.begin() + node.count + 1);
+            node.elements[index] = str;
+            node.count++;
+        }
+
+        // Function makes sure that node is not shared with other sequences before it is changed.
+        static void detach(Node_ptr &node) {
+            if (!node.is_unique())
+                node = make_shared_object<Node_t>(*node);
+        }
+
+        static Node_ptr rotate_right(Node_ptr node) {
+            Node_ptr left = std::move(node->left);
+            detach(left);
+            node->left = std::move(left->right);
+            update(*node);
+            left->right = std::move(node);
+            update(*left);
+            return left;
+        }
+
+        static Node_ptr rotate_left(Node_ptr node) {
+            Node_ptr right = std::move(node->right);
+            detach(right);
+            node->right = std::move(right->left);
+            update(*node);
+            right->left = std::move(node);
+            update(*right);
+            return right;
+        }
+
+        // Function places new node before all nodes of subtree.
+        static Node_ptr insert_front(Node_ptr node, Node_ptr inserted) {
+            if (node == nullptr)
+                return inserted;
+
+            detach(node);
+            node->left = insert_front(std::move(node->left), std::move(inserted));
+            if (node->left->priority > node->priority)
+                return rotate_right(std::move(node));
+            update(*node);
+            return node;
+        }
+
+        static Node_ptr insert(Node_ptr node, std::size_t position, const char *str) {
+            if (node == nullptr) {
+                node = new_node();
+                insert_into_chunk(*node, 0, str);
+                update_chunk(*node);
+                update(*node);
+                return node;
+            }
+
+            detach(node);
+            const std::size_t left_size = size_of(node->left);
+            if (position < left_size || (position == left_size && node->left != nullptr)) {
+                node->left = insert(std::move(node->left), position, str);
+                if (node->left->priority > node->priority)
+                    return rotate_right(std::move(node));
+            } else if (position <= left_size + node->count) {
+                std::uint32_t index = position - left_size;
+                if (node->count < CHUNK_CAPACITY) {
+                    insert_into_chunk(*node, index, str);
+                    update_chunk(*node);
+                } else {
+                    // Full chunk is split in half and upper part goes to a new node right after this one.
+                    // When string is appended at its end, chunk stays full and only the string is moved.
+                    const std::uint32_t split = index == CHUNK_CAPACITY ? CHUNK_CAPACITY : CHUNK_CAPACITY / 2;
+                    Node_ptr upper = new_node();
+                    std::copy(node->elements.begin() + split, node->elements.end(), upper->elements.begin());
+                    upper->count = CHUNK_CAPACITY - split;
+                    node->count = split;
+
+                    if (index > split || split == CHUNK_CAPACITY)
+                        insert_into_chunk(*upper, index - split, str);
+                    else
+                        insert_into_chunk(*node, index, str);
+                    update_chunk(*node);
+                    update_chunk(*upper);
+                    update(*upper);
+
+                    node->right = insert_front(std::move(node->right), std::move(upper));
+                    if (node->right->priority > node->priority)
+                        return rotate_left(std::move(node));
+                }
+            } else {
+                node->right = insert(std::move(node->right), position - left_size - node->count, str);
+                if (node->right->priority > node->priority)
+                    return rotate_left(std::move(node));
+            }
+
+            update(*node);
+            return node;
+        }
+
+        // Function joins two subtrees, all elements of first one are placed before elements of second one.
+        static Node_ptr merge(Node_ptr first, Node_ptr second) {
+            if (first == nullptr)
+                return second;
+            if (second == nullptr)
+                return first;
+
+            if (first->priority > second->priority) {
+                detach(first);
+                first->right = merge(std::move(first->right), std::move(second));
+                update(*first);
+                return first;
+            }
+            detach(second);
+            second->left = merge(std::move(first), std::move(second->left));
+            update(*second);
+            return second;
+        }
+
+        // Function divides subtree into first position elements and the rest. Chunk containing
+        // position is cut and its upper part becomes root of the second subtree.
+        static std::pair<Node_ptr, Node_ptr> split(Node_ptr node, std::size_t position) {
+            if (node == nullptr)
+                return {nullptr, nullptr};
+
+            detach(node);
+            const std::size_t left_size = size_of(node->left);
+            if (position <= left_size) {
+                auto [before, after] = split(std::move(node->left), position);
+                node->left = std::move(after);
+                update(*node);
+                return {std::move(before), std::move(node)};
+            }
+
+            if (position >= left_size + node->count) {
+                auto [before, after] = split(std::move(node->right), position - left_size - node->count);
+                node->right = std::move(before);
+                update(*node);
+                return {std::move(node), std::move(after)};
+            }
+
+            const std::uint32_t index = position - left_size;
+            Node_ptr upper = make_shared_object<Node_t>();
+            upper->priority = node->priority;
+            std::copy(node->elements.begin() + index, node->elements.begin() + node->count, upper->elements.begin());
+            upper->count = node->count - index;
+            upper->right = std::move(node->right);
+            update_chunk(*upper);
+            update(*upper);
+            node->count = index;
+            update_chunk(*node);
+            update(*node);
+            return {std::move(node), std::move(upper)};
+        }
+
+        static Node_ptr erase(Node_ptr node, std::size_t position, const char *&erased) {
+            detach(node);
+            const std::size_t left_size = size_of(node->left);
+            if (position < left_size) {
+                node->left = erase(std::move(node->left), position, erased);
+            } else if (position < left_size + node->count) {
+                const std::uint32_t index = position - left_size;
+                erased = node->elements[index];
+                std::copy(node->elements.begin() + index + 1, node->elements.begin() + node->count,
+                          node->elements.begin() + index);
+                node->count--;
+
+                // Empty chunks are removed, so number of nodes never exceeds number of elements.
+                if (node->count == 0)
+                    return merge(std::move(node->left), std::move(node->right));
+                update_chunk(*node);
+            } else {
+                node->right = erase(std::move(node->right), position - left_size - node->count, erased);
+            }
+
+            update(*node);
+            return node;
+        }
+
+        Node_ptr root;
+    };
+
+    // Queue of strings owned by its string store.
+    class Queue_t {
+    public:
+        // Strings of journaled queue are kept in the journal instead of its store.
+        explicit Queue_t(bool is_journaled = false) : is_journaled(is_journaled) {}
+
+        std::size_t size() const {
+            return strings.size();
+        }
+
+        bool empty() const {
+            return strings.empty();
+        }
+
+        const char *at(std::size_t position) const {
+            return strings.at(position);
+        }
+
+        void push_back(const char *str) {
+            strings.insert(strings.size(), store.insert(str));
+        }
+
+        void insert(std::size_t position, const char *str) {
+            strings.insert(position, store.insert(str));
+        }
+
+        // Null strings are skipped. Space for all short strings is reserved before they are copied.
+        void insert(std::size_t position, const char *const *strs, std::size_t count) {
+            std::vector<std::size_t> lengths(count);
+            std::size_t entries_size = 0;
+            for (std::size_t i = 0; i < count; i++) {
+                if (strs[i] == nullptr)
+                    continue;
+                lengths[i] = std::strlen(strs[i]);
+                if (String_store_t::entry_size(lengths[i]) <= String_store_t::LARGE_ENTRY)
+                    entries_size += String_store_t::entry_size(lengths[i]);
+            }
+            store.reserve(entries_size);
+
+            std::vector<const char *> stored;
+            stored.reserve(count);
+            for (std::size_t i = 0; i < count; i++)
+                if (strs[i] != nullptr)
+                    stored.push_back(store.insert(strs[i], lengths[i]));
+
+            strings.insert(std::min(position, size()), stored.data(), stored.size());
+        }
+
+        // Function inserts count strings, whose entries follow one another in the journal, before position.
+        void insert_journaled(std::size_t position, const char *first_str, std::size_t count) {
+            std::vector<const char *> journaled(count);
+            for (std::size_t i = 0; i < count; i++, first_str = String_store_t::next(first_str))
+                journaled[i] = first_str;
+            strings.insert(std::min(position, size()), journaled.data(), count);
+        }
+
+        void erase(std::size_t position) {
+            release(strings.erase(position));
+        }
+
+        void erase(std::size_t position, std::size_t count) {
+            strings.erase(position, count, [this](const char *str) {
+                release(str);
+            });
+        }
+
+        // Function copies at most count pointers to strings starting from position and returns their number.
+        std::size_t copy(std::size_t position, std::size_t count, const char **strs) const {
+            if (position >= size())
+                return 0;
+
+            count = std::min(count, size() - position);
+            auto str = strings.iterator_at(position);
+            for (std::size_t i = 0; i < count; i++, ++str)
+                strs[i] = *str;
+            return count;
+        }
+
+        void clear() {
+            strings.clear();
+            store.clear();
+        }
+
+        // Function makes empty clone contain the same strings in constant time. Both queues share them until
+        // they are changed, then only changed chunks are copied.
+        void share(Queue_t &clone) {
+            clone.strings = strings;
+            store.share(clone.store);
+        }
+
+        // Queues of different sizes, or with content hashes different hashes, are found unequal in constant time.
+        // Otherwise strings are compared.
+        friend bool operator==(const Queue_t &queue_1, const Queue_t &queue_2) {
+            if (queue_1.size() != queue_2.size())
+                return false;
+            if constexpr (content_hash) {
+                if (queue_1.strings.hash() != queue_2.strings.hash())
+                    return false;
+            }
+            return std::equal(queue_1.strings.begin(), queue_1.strings.end(), queue_2.strings.begin(),
+                              [](const char *str_1, const char *str_2) {
+                                  return String_store_t::view(str_1) == String_store_t::view(str_2);
+                              });
+        }
+
+        // Queues are compared lexicographically in one pass.
+        friend std::strong_ordering operator<=>(const Queue_t &queue_1, const Queue_t &queue_2) {
+            return std::lexicographical_compare_three_way(queue_1.strings.begin(), queue_1.strings.end(),
+                                                          queue_2.strings.begin(), queue_2.strings.end(),
+                                                          [](const char *str_1, const char *str_2) {
+                                                              return String_store_t::view(str_1) <=>
+                                                                     String_store_t::view(str_2);
+                                                          });
+        }
+
+    private:
+        void release(const char *str) {
+            if (!is_journaled)
+                store.erase(str);
+        }
+
+        Sequence_t strings;
+        String_store_t store;
+        bool is_journaled;
+    };
+
+    // Id of queue keeps index of its slot in lower three quarters of bits and generation of that slot in the rest.
+    // Generation is increased every time queue is deleted, so slots are reused, but ids are not. Slot whose
+    // generations run out is retired, so all values of Id_t can be used as ids, as when they were counted,
+    // and even 32 bit ids allow millions of queues to exist at once.
+    constexpr int SLOT_BITS = std::numeric_limits<Id_t>::digits / 4 * 3;
+    constexpr Id_t SLOT_MASK = (Id_t{1} << SLOT_BITS) - 1;
+    constexpr Id_t LAST_GENERATION = std::numeric_limits<Id_t>::max() >> SLOT_BITS;
+    // Id returned when queue can't be created. It would belong to the last slot, which is never used.
+    constexpr Id_t NO_QUEUE = std::numeric_limits<Id_t>::max();
+    constexpr Id_t SLOTS_COUNT = SLOT_MASK;
+
+    // Slots are kept in chunks, each twice as big as the previous one, so they never move.
+    constexpr int FIRST_CHUNK_BITS = 6;
+    constexpr int MAX_CHUNKS = SLOT_BITS - FIRST_CHUNK_BITS + 1;
+    static_assert((Id_t{1} << (MAX_CHUNKS + FIRST_CHUNK_BITS)) - (Id_t{1} << FIRST_CHUNK_BITS) >= SLOTS_COUNT,
+                  "Chunks have to hold all slots.");
+
+    // Mutex used when library isn't built as thread safe.
+    struct No_mutex_t {
+        void lock() {}
+        void unlock() {}
+        bool try_lock() { return true; }
+    };
+
+    using Mutex_t = std::conditional_t<thread_safe, std::mutex, No_mutex_t>;
+
+    // Journal of changes of queues kept in memory mapped file, so queues can be restored after restart.
+    // File is a sequence of segments, each mapped separately, so strings written to it never move and
+    // queues point straight to them. Segment holds records of operations one after another and record of
+    // size 0 ends it. Size of record is written last and checksum covers the whole record, so operation
+    // interrupted by a crash is ignored together with everything after it.
+    class Journal_t {
+    public:
+        enum class Operation_t : std::uint32_t {
+            create = 1,
+            erase_queue,
+            insert,
+            erase,
+            erase_range,
+            clear,
+            clone,
+            // Slot without queue and its id, written by checkpoint, so ids of deleted queues are not repeated.
+            free_slot
+        };
+
+        struct Record_t {
+            Operation_t operation;
+            std::span<const std::uint64_t> values;
+            // Strings of record, whose entries follow one another.
+            const char *first_str;
+            std::size_t strings_count;
+        };
+
+        bool is_open() const {
+            return file_descriptor != -1;
+        }
+
+        // Function opens journal in given file, creating it if needed, and calls apply for each record in it.
+        // Returns false if file can't be used as a journal.
+        template <typename Apply>
+        bool open(const char *path, const Apply &apply) {
+            if (!map_file(path)) {
+                close();
+                return false;
+            }
+
+            file_path = path;
+            replay(apply);
+            return true;
+        }
+
+        // Function calls apply for each record of journal.
+        template <typename Apply>
+        void replay(const Apply &apply) const {
+            for (const Segment_t &segment : segments)
+                for (std::size_t used = sizeof(Segment_header_t); used < segment.used;
+                     used += record_header(segment.data + used).size)
+                    apply(read_record(segment.data + used));
+        }
+
+        // Function returns total size of records in journal.
+        std::size_t size() const {
+            std::size_t size = 0;
+            for (const Segment_t &segment : segments)
+                size += segment.used - sizeof(Segment_header_t);
+            return size;
+        }
+
+        // Function returns size of record with given number of values and strings of given lengths in total.
+        static std::size_t record_size(std::size_t values_count, std::size_t entries_size) {
+            return sizeof(Record_header_t) + values_count * sizeof(std::uint64_t) + entries_size;
+        }
+
+        // Function writes journal again as records written by write_records to journal given to it, so history
+        // of operations is replaced by their result. New file replaces the old one only when it's complete
+        // and later records are appended to it. Segments of the old file stay mapped until unmap_replaced is
+        // called, because queues point to their strings. Caller has to make sure that no operation is written
+        // before records of its queue. Returns false if new file can't be written, then journal doesn't change.
+        template <typename Write>
+        bool checkpoint(const Write &write_records) {
+            std::lock_guard<Mutex_t> journal_lock(mutex);
+            const std::string checkpoint_path = file_path + ".checkpoint";
+            Journal_t written;
+            written.file_descriptor = ::open(checkpoint_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            bool is_written = written.file_descriptor != -1 && written.add_segment(0) && write_records(written);
+
+            // File has to be on disk before it replaces the old one, so crash can't leave journal without data.
+            for (const Segment_t &segment : written.segments)
+                is_written = is_written && msync(segment.data, segment.size, MS_SYNC) == 0;
+            is_written = is_written && fsync(written.file_descriptor) == 0 &&
+                         rename(checkpoint_path.c_str(), file_path.c_str()) == 0;
+            if (!is_written) {
+                written.close();
+                unlink(checkpoint_path.c_str());
+                return false;
+            }
+
+            ::close(file_descriptor);
+            replaced_segments.insert(replaced_segments.end(), segments.begin(), segments.end());
+            segments = std::move(written.segments);
+            end_offset = written.end_offset;
+            file_descriptor = written.file_descriptor;
+            return true;
+        }
+
+        // Function unmaps segments of files replaced by checkpoints. Nothing may point to their strings.
+        void unmap_replaced() {
+            for (const Segment_t &segment : replaced_segments)
+                munmap(segment.data, segment.size);
+            replaced_segments.clear();
+        }
+
+        // Function appends record with given values and not null strings from strs to the journal and sets stored
+        // to the copy of first of them. Returns false if file can't be extended.
+        bool append(Operation_t operation, std::initializer_list<std::uint64_t> values,
+                    const char *const *strs = nullptr, std::size_t count = 0, const char **stored = nullptr) {
+            std::size_t record_size = sizeof(Record_header_t) + values.size() * sizeof(std::uint64_t);
+            std::size_t strings_count = 0;
+            for (std::size_t i = 0; i < count; i++) {
+                if (strs[i] != nullptr) {
+                    record_size += String_store_t::entry_size(std::strlen(strs[i]));
+                    strings_count++;
+                }
+            }
+
+            std::lock_guard<Mutex_t> journal_lock(mutex);
+            if (segments.back().size - segments.back().used < record_size && !add_segment(record_size))
+                return false;
+
+            Segment_t &segment = segments.back();
+            char *record = segment.data + segment.used;
+            char *end = record + sizeof(Record_header_t);
+            for (std::uint64_t value : values) {
+                std::memcpy(end, &value, sizeof(std::uint64_t));
+                end += sizeof(std::uint64_t);
+            }
+            for (std::size_t i = 0; i < count; i++) {
+                if (strs[i] == nullptr)
+                    continue;
+                const std::size_t length = std::strlen(strs[i]);
+                const char *str = String_store_t::write_entry(end, strs[i], length);
+                if (stored != nullptr) {
+                    *stored = str;
+                    stored = nullptr;
+                }
+                end += String_store_t::entry_size(length);
+            }
+
+            Record_header_t header{record_size, 0, operation, static_cast<std::uint32_t>(values.size()),
+                                   strings_count};
+            std::memcpy(record, &header, sizeof(header));
+            header.checksum = checksum(record, record_size);
+            // Size is written after the rest, record without it is treated as the end of journal.
+            std::memcpy(record + sizeof(std::uint64_t), &header.checksum, sizeof(std::uint64_t));
+            std::memcpy(record, &header.size, sizeof(std::uint64_t));
+            segment.used += record_size;
+            return true;
+        }
+
+    private:
+        static constexpr char MAGIC[8] = {'s', 't', 'r', 'q', 'u', 'e', 'u', 'e'};
+        static constexpr std::size_t SEGMENT_SIZE = 1 << 26;
+        // Slots are taken in order of their indexes, but creations by different threads can be written out of
+        // order, so slot of a record can be at most this far past the slots of records before it. Slots beyond
+        // that could only come from a damaged file and would make replay allocate chunks of slots for nothing.
+        static constexpr Id_t MAX_SLOTS_SKIPPED = 1 << 16;
+
+        struct Segment_header_t {
+            char magic[8];
+            std::uint64_t size;
+            // Journal can be read only by builds with the same layout of entries of strings and of ids.
+            std::uint64_t entry_header_size;
+            std::uint64_t slot_bits;
+            std::uint64_t string_hash_base;
+        };
+
+        struct Record_header_t {
+            std::uint64_t size;
+            std::uint64_t checksum;
+            Operation_t operation;
+            std::uint32_t values_count;
+            std::uint64_t strings_count;
+        };
+
+        struct Segment_t {
+            char *data;
+            std::size_t size;
+            // Size of segment header and complete records.
+            std::size_t used;
+        };
+
+        static bool is_valid(const Segment_header_t &header, std::size_t available) {
+            return std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                   header.entry_header_size == String_store_t::HEADER_SIZE && header.slot_bits == SLOT_BITS &&
+                   header.size >= sizeof(Segment_header_t) && header.size <= available &&
+                   header.size % page_size() == 0;
+        }
+
+        static Record_header_t record_header(const char *record) {
+            Record_header_t header;
+            std::memcpy(&header, record, sizeof(header));
+            return header;
+        }
+
+        static bool is_valid(const char *record, std::size_t available) {
+            const Record_header_t header = record_header(record);
+            return header.size >= sizeof(Record_header_t) && header.size <= available &&
+                   header.size % String_store_t::ALIGNMENT == 0 &&
+                   header.values_count <= (header.size - sizeof(Record_header_t)) / sizeof(std::uint64_t) &&
+                   header.checksum == checksum(record, header.size);
+        }
+
+        // Function returns number of values of records of given operation, or 0 if operation is unknown.
+        static std::uint32_t values_count(Operation_t operation) {
+            switch (operation) {
+                case Operation_t::create:
+                case Operation_t::erase_queue:
+                case Operation_t::clear:
+                    return 1;
+                case Operation_t::insert:
+                case Operation_t::erase:
+                case Operation_t::clone:
+                case Operation_t::free_slot:
+                    return 2;
+                case Operation_t::erase_range:
+                    return 3;
+            }
+            return 0;
+        }
+
+        // Function checks that complete record can be replayed: it has the values of its operation, only insert
+        // has strings, their entries fill exactly the rest of record and slot of create or free_slot is valid and
+        // at most MAX_SLOTS_SKIPPED past slots_count, the number of slots used by previous records, which is
+        // updated. Every length is checked against bytes left in record, so nothing is read outside of it.
+        static bool is_well_formed(const char *record, Id_t &slots_count) {
+            const Record_header_t header = record_header(record);
+            if (header.values_count == 0 || header.values_count != values_count(header.operation) ||
+                (header.operation != Operation_t::insert && header.strings_count != 0))
+                return false;
+
+            const char *values = record + sizeof(Record_header_t);
+            const char *entry = values + header.values_count * sizeof(std::uint64_t);
+            const char *end = record + header.size;
+            for (std::uint64_t i = 0; i < header.strings_count; i++) {
+                const std::size_t left = end - entry;
+                if (left <= String_store_t::HEADER_SIZE)
+                    return false;
+                const char *str = entry + String_store_t::HEADER_SIZE;
+                const std::size_t length = String_store_t::length(str);
+                if (length >= left - String_store_t::HEADER_SIZE || str[length] != '\0')
+                    return false;
+                entry += String_store_t::entry_size(length);
+            }
+            if (entry != end)
+                return false;
+
+            if (header.operation != Operation_t::create && header.operation != Operation_t::free_slot)
+                return true;
+            std::uint64_t first_value;
+            std::memcpy(&first_value, values, sizeof(std::uint64_t));
+            const Id_t slot_index = header.operation == Operation_t::create ? first_value & SLOT_MASK : first_value;
+            if (slot_index >= SLOTS_COUNT || slot_index > slots_count + MAX_SLOTS_SKIPPED)
+                return false;
+            if (header.operation == Operation_t::free_slot) {
+                std::uint64_t id;
+                std::memcpy(&id, values + sizeof(std::uint64_t), sizeof(std::uint64_t));
+                if (id != ~Id_t{0} && (id & SLOT_MASK) != slot_index)
+                    return false;
+            }
+            slots_count = std::max(slots_count, slot_index + 1);
+            return true;
+        }
+
+        static Record_t read_record(const char *record) {
+            const Record_header_t header = record_header(record);
+            const auto *values = reinterpret_cast<const std::uint64_t *>(record + sizeof(Record_header_t));
+            return {header.operation, std::span<const std::uint64_t>(values, header.values_count),
+                    reinterpret_cast<const char *>(values + header.values_count) + String_store_t::HEADER_SIZE,
+                    header.strings_count};
+        }
+
+        // Function computes checksum of record, treating its checksum as 0.
+        static std::uint64_t checksum(const char *record, std::size_t size) {
+            std::uint64_t checksum = 14695981039346656037u;
+            for (std::size_t i = 0; i < size; i += sizeof(std::uint64_t)) {
+                std::uint64_t word = 0;
+                if (i != offsetof(Record_header_t, checksum))
+                    std::memcpy(&word, record + i, sizeof(std::uint64_t));
+                checksum = (checksum ^ word) * 1099511628211u;
+                checksum ^= checksum >> 29;
+            }
+            return checksum;
+        }
+
+        static std::size_t page_size() {
+            static const std::size_t size = sysconf(_SC_PAGESIZE);
+            return size;
+        }
+
+        // Function maps all segments of file and finds their complete records.
+        bool map_file(const char *path) {
+            file_descriptor = ::open(path, O_RDWR | O_CREAT, 0644);
+            struct stat file_status;
+            if (file_descriptor == -1 || fstat(file_descriptor, &file_status) == -1)
+                return false;
+
+            const std::size_t file_size = file_status.st_size;
+            bool is_torn = false;
+            Id_t slots_count = 0;
+            while (end_offset < file_size && !is_torn) {
+                Segment_header_t header;
+                if (pread(file_descriptor, &header, sizeof(header), end_offset) != sizeof(header) ||
+                    !is_valid(header, file_size - end_offset)) {
+                    // Only segment which was being added when program stopped can be invalid.
+                    if (end_offset == 0)
+                        return false;
+                    break;
+                }
+
+                char *data = map(end_offset, header.size);
+                if (data == nullptr)
+                    return false;
+                Segment_t &segment = segments.emplace_back(Segment_t{data, header.size, sizeof(Segment_header_t)});
+                end_offset += header.size;
+
+                while (segment.size - segment.used >= sizeof(Record_header_t)) {
+                    const char *record = data + segment.used;
+                    if (record_header(record).size == 0)
+                        break;
+                    if (!is_valid(record, segment.size - segment.used)) {
+                        // Part written when program stopped is removed, so new records can be written over it.
+                        std::memset(data + segment.used, 0, segment.size - segment.used);
+                        is_torn = true;
+                        break;
+                    }
+                    // Complete record which can't be replayed means that file was damaged or isn't a journal,
+                    // like a file with a bad header, so it's not used and nothing is restored from it.
+                    if (!is_well_formed(record, slots_count))
+                        return false;
+                    segment.used += record_header(record).size;
+                }
+            }
 
-    // Initialization of map of queues.
-    static Map_t &map_of_queues() {
-        static Map_t map = Map_t();
-        return map;
+            if (end_offset < file_size && ftruncate(file_descriptor, end_offset) == -1)
+                return false;
+            if (segments.empty())
+                return add_segment(0);
+
+            Segment_header_t first_header;
+            std::memcpy(&first_header, segments.front().data, sizeof(first_header));
+            string_hash_base() = first_header.string_hash_base;
+            return true;
+        }
+
+        char *map(std::size_t offset, std::size_t size) {
+            void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file_descriptor, offset);
+            return mapping == MAP_FAILED ? nullptr : static_cast<char *>(mapping);
+        }
+
+        // Function adds segment big enough for record of given size at the end of file.
+        bool add_segment(std::size_t record_size) {
+            const std::size_t needed = sizeof(Segment_header_t) + record_size + sizeof(Record_header_t);
+            const std::size_t size = std::max(SEGMENT_SIZE, (needed + page_size() - 1) / page_size() * page_size());
+            if (ftruncate(file_descriptor, end_offset + size) == -1)
+                return false;
+            // Extended part of file, which could not be mapped, is removed when journal is opened again.
+            char *segment = map(end_offset, size);
+            if (segment == nullptr)
+                return false;
+
+            Segment_header_t header{};
+            std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.size = size;
+            header.entry_header_size = String_store_t::HEADER_SIZE;
+            header.slot_bits = SLOT_BITS;
+            header.string_hash_base = string_hash_base();
+            std::memcpy(segment, &header, sizeof(header));
+
+            segments.push_back({segment, size, sizeof(Segment_header_t)});
+            end_offset += size;
+            return true;
+        }
+
+        void close() {
+            for (const Segment_t &segment : segments)
+                munmap(segment.data, segment.size);
+            segments.clear();
+            end_offset = 0;
+            if (file_descriptor != -1)
+                ::close(file_descriptor);
+            file_descriptor = -1;
+        }
+
+        // Segments of open journal stay mapped until the end of program, because queues point to their strings.
+        std::vector<Segment_t> segments;
+        std::vector<Segment_t> replaced_segments;
+        std::size_t end_offset = 0;
+        int file_descriptor = -1;
+        std::string file_path;
+        Mutex_t mutex;
+    };
+
+    static Journal_t &journal() {
+        static Journal_t journal;
+        return journal;
     }
 
-    // Function returns pointer to queue with given id.
-    static std::deque<std::string> *find_queue(Id_t id) {
-        Map_t &map = map_of_queues();
-        auto found_queue_iterator = map.find(id);
+    struct Slot_t {
+        Id_t id = 0;
+        // Mutex guards id and queue, so operations on different queues don't wait for each other.
+        Mutex_t mutex;
+        // Queue is nullptr when slot is free.
+        std::unique_ptr<Queue_t> queue;
+    };
+
+    struct Registry_t {
+        std::array<std::atomic<Slot_t *>, MAX_CHUNKS> chunks{};
+        std::atomic<Id_t> next_slot{0};
+        Mutex_t free_slots_mutex;
+        std::vector<Id_t> free_slots;
+
+        ~Registry_t() {
+            for (auto &chunk: chunks)
+                delete[] chunk.load();
+        }
+    };
+
+    // Initialization of registry of queues.
+    static Registry_t &registry() {
+        static Registry_t registry;
+        return registry;
+    }
 
-        if (found_queue_iterator == map.end())
+    // Function returns slot with given index. If its chunk doesn't exist it's created when allocate is true,
+    // otherwise nullptr is returned. Index out of range of slots gives nullptr as well.
+    static Slot_t *slot_at(Id_t slot_index, bool allocate) {
+        if (slot_index >= SLOTS_COUNT)
             return nullptr;
 
-        return &found_queue_iterator->second;
+        const Id_t offset = slot_index + (Id_t{1} << FIRST_CHUNK_BITS);
+        const int chunk = std::bit_width(offset) - 1 - FIRST_CHUNK_BITS;
+        const Id_t first_in_chunk = (Id_t{1} << (chunk + FIRST_CHUNK_BITS)) - (Id_t{1} << FIRST_CHUNK_BITS);
+
+        std::atomic<Slot_t *> &chunk_slots = registry().chunks[chunk];
+        Slot_t *slots = chunk_slots.load(std::memory_order_acquire);
+        if (slots == nullptr && allocate) {
+            const Id_t chunk_size = Id_t{1} << (chunk + FIRST_CHUNK_BITS);
+            Slot_t *new_slots = new Slot_t[chunk_size];
+            for (Id_t i = 0; i < chunk_size; i++)
+                new_slots[i].id = first_in_chunk + i;
+
+            // If other thread created this chunk first, its slots are used.
+            if (chunk_slots.compare_exchange_strong(slots, new_slots, std::memory_order_acq_rel))
+                slots = new_slots;
+            else
+                delete[] new_slots;
+        }
+
+        return slots == nullptr ? nullptr : &slots[slot_index - first_in_chunk];
     }
 
-    // Function prints function name and it's parameters.
-    static void debug_function_call_arguments(const std::string &function_name,
-                                              const std::vector<Id_t> &arguments) {
-        std::cerr << function_name << "(";
-        if (!arguments.empty())
-            for (size_t i = 0; i < arguments.size() - 1; i++)
-                std::cerr << arguments[i] << ", ";
+    // Queue found by id together with lock of its slot, which is held until the end of operation.
+    class Locked_queue_t {
+    public:
+        Locked_queue_t(Slot_t *slot, Id_t id, std::unique_lock<Mutex_t> lock) : lock(std::move(lock)) {
+            if (slot != nullptr && slot->id == id)
+                queue = slot->queue.get();
+        }
+
+        Queue_t *operator->() const {
+            return queue;
+        }
+
+        Queue_t &operator*() const {
+            return *queue;
+        }
+
+        bool operator==(std::nullptr_t) const {
+            return queue == nullptr;
+        }
+
+    private:
+        std::unique_lock<Mutex_t> lock;
+        Queue_t *queue = nullptr;
+    };
 
-        if (!arguments.empty())
-            std::cerr << arguments[arguments.size() - 1];
+    // Function returns queue with given id locked for the caller.
+    static Locked_queue_t find_queue(Id_t id) {
+        Slot_t *slot = slot_at(id & SLOT_MASK, false);
+        if (slot == nullptr)
+            return Locked_queue_t(nullptr, id, std::unique_lock<Mutex_t>());
 
-        std::cerr << ")" << std::endl;
+        return Locked_queue_t(slot, id, std::unique_lock<Mutex_t>(slot->mutex));
     }
 
-    static void debug_function_call_arguments(const std::string &function_name,
-                                              const std::vector<Id_t> &arguments, const char *str) {
-        std::cerr << function_name << "(";
-        if (!arguments.empty())
-            for (size_t i = 0; i < arguments.size() - 1; i++)
-                std::cerr << arguments[i] << ", ";
+    // Function returns two queues locked for the caller. Locks are taken without risk of deadlock
+    // and slot shared by both ids is locked only once.
+    static std::pair<Locked_queue_t, Locked_queue_t> find_queues(Id_t id1, Id_t id2) {
+        Slot_t *slot_1 = slot_at(id1 & SLOT_MASK, false);
+        Slot_t *slot_2 = slot_at(id2 & SLOT_MASK, false);
+        std::unique_lock<Mutex_t> lock_1, lock_2;
 
-        if (!arguments.empty())
-            std::cerr << arguments[arguments.size() - 1];
+        if (slot_1 != nullptr && slot_2 != nullptr && slot_1 != slot_2) {
+            lock_1 = std::unique_lock<Mutex_t>(slot_1->mutex, std::defer_lock);
+            lock_2 = std::unique_lock<Mutex_t>(slot_2->mutex, std::defer_lock);
+            std::lock(lock_1, lock_2);
+        } else if (slot_1 != nullptr) {
+            lock_1 = std::unique_lock<Mutex_t>(slot_1->mutex);
+        } else if (slot_2 != nullptr) {
+            lock_2 = std::unique_lock<Mutex_t>(slot_2->mutex);
+        }
 
-        if (str == nullptr)
-            std::cerr << ", NULL";
-        else
-            std::cerr << ", \"" << str << "\"";
+        return {Locked_queue_t(slot_1, id1, std::move(lock_1)), Locked_queue_t(slot_2, id2, std::move(lock_2))};
+    }
+
+    // Debug trace. Calls are recorded in a buffer of calling thread and printed to std::cerr
+    // when the buffer gets full and when the thread ends, so recording never allocates memory,
+    // takes locks or waits for output. Buffers of all threads are also printed when program is killed
+    // by a signal of failed assertion or invalid memory access. Build with STRQUEUE_SYNC_TRACE defined
+    // to print every call at once, in order with other output written to std::cerr.
+    enum class Trace_kind_t : std::uint8_t {
+        arguments,
+        result,
+        status,
+        queue_not_found,
+        not_existing_element
+    };
+
+    enum class Trace_text_t : std::uint8_t {
+        none,
+        null,
+        string
+    };
+
+    struct Trace_record_t {
+        const char *function_name;
+        // Status of status record.
+        const char *status;
+        // Arguments of arguments record, result of result record, id and position of the others.
+        std::array<Id_t, 3> values;
+        const char *text;
+        std::size_t text_length;
+        Trace_kind_t kind;
+        Trace_text_t text_type;
+        std::uint8_t values_count;
+        bool is_signed;
+    };
+
+    // Function passes text of record, followed by new line, to write in parts. It doesn't allocate memory,
+    // so it's used also by handler of signals.
+    template <typename Write>
+    static void format_trace_record(const Trace_record_t &record, const Write &write) {
+        auto text = [&write](std::string_view part) {
+            write(part.data(), part.size());
+        };
+        auto number = [&write](auto value) {
+            std::array<char, std::numeric_limits<Id_t>::digits10 + 3> digits;
+            write(digits.data(), std::to_chars(digits.begin(), digits.end(), value).ptr - digits.data());
+        };
+        auto string_or_null = [&text](const Trace_record_t &record) {
+            if (record.text_type == Trace_text_t::null) {
+                text("NULL");
+            } else if (record.text_type == Trace_text_t::string) {
+                text("\"");
+                text(std::string_view(record.text, record.text_length));
+                text("\"");
+            }
+        };
+
+        text(record.function_name);
+        switch (record.kind) {
+            case Trace_kind_t::arguments:
+                text("(");
+                for (std::uint8_t i = 0; i < record.values_count; i++) {
+                    text(i == 0 ? "" : ", ");
+                    number(record.values[i]);
+                }
+                if (record.text_type != Trace_text_t::none && record.values_count != 0)
+                    text(", ");
+                string_or_null(record);
+                text(")");
+                break;
+            case Trace_kind_t::result:
+                text(" returns ");
+                if (record.text_type != Trace_text_t::none)
+                    string_or_null(record);
+                else if (record.is_signed)
+                    number(static_cast<std::int32_t>(record.values[0]));
+                else
+                    number(record.values[0]);
+                break;
+            case Trace_kind_t::status:
+                text(" ");
+                text(record.status);
+                break;
+            case Trace_kind_t::queue_not_found:
+                text(": queue ");
+                number(record.values[0]);
+                text(" does not exist");
+                break;
+            case Trace_kind_t::not_existing_element:
+                text(": queue ");
+                number(record.values[0]);
+                text(" does not contain string at position ");
+                number(record.values[1]);
+                break;
+        }
+        text("\n");
+    }
+
+    class Trace_buffer_t;
+
+    // Buffers of threads which have them, read by handler of signals.
+    constexpr std::size_t MAX_TRACED_THREADS = 256;
+    static std::array<std::atomic<Trace_buffer_t *>, MAX_TRACED_THREADS> trace_buffers;
+    // Buffer of calling thread, which unlike thread local object can be read in handler of signals.
+    static thread_local Trace_buffer_t *current_trace_buffer = nullptr;
+
+    class Trace_buffer_t {
+    public:
+        Trace_buffer_t() {
+            [[maybe_unused]] static const bool are_handlers_installed = install_signal_handlers();
+
+            current_trace_buffer = this;
+            // Buffer of thread over the limit is printed on signal only if the thread gets it.
+            for (auto &buffer : trace_buffers) {
+                Trace_buffer_t *empty = nullptr;
+                if (buffer.compare_exchange_strong(empty, this))
+                    break;
+            }
+        }
+
+        Trace_buffer_t(const Trace_buffer_t &) = delete;
+        Trace_buffer_t &operator=(const Trace_buffer_t &) = delete;
+
+        ~Trace_buffer_t() {
+            flush();
+            // Calls made later by destructors of other objects are printed at once.
+            is_closed = true;
+            for (auto &buffer : trace_buffers) {
+                Trace_buffer_t *registered = this;
+                if (buffer.compare_exchange_strong(registered, nullptr))
+                    break;
+            }
+        }
+
+        // Function stores copy of record, its string is copied to the buffer as well.
+        void add(const Trace_record_t &record) {
+            if (is_closed || sync_trace) {
+                print({&record, 1});
+                return;
+            }
+
+            if (records_count.load(std::memory_order_relaxed) == MAX_RECORDS ||
+                record.text_length > MAX_TEXT - text_size)
+                flush();
+
+            const std::size_t count = records_count.load(std::memory_order_relaxed);
+            Trace_record_t &added = records[count];
+            added = record;
+            if (record.text_type == Trace_text_t::string && record.text_length <= MAX_TEXT) {
+                std::memcpy(text.data() + text_size, record.text, record.text_length);
+                added.text = text.data() + text_size;
+                text_size += record.text_length;
+            }
+            // Record is counted when it's complete, so handler of signals never prints a partial one.
+            records_count.store(count + 1, std::memory_order_release);
+
+            // Too long string is printed before it can change.
+            if (record.text_type == Trace_text_t::string && record.text_length > MAX_TEXT)
+                flush();
+        }
+
+        void flush() {
+            print({records.data(), records_count.load(std::memory_order_relaxed)});
+            records_count.store(0, std::memory_order_relaxed);
+            text_size = 0;
+        }
+
+    private:
+        static constexpr std::size_t MAX_RECORDS = 1024;
+        static constexpr std::size_t MAX_TEXT = 1 << 15;
+        static constexpr std::array<int, 5> FATAL_SIGNALS = {SIGABRT, SIGSEGV, SIGBUS, SIGFPE, SIGILL};
+
+        static void print(std::span<const Trace_record_t> printed) {
+            if (printed.empty())
+                return;
+
+            // Records of one thread are printed together.
+            static Mutex_t output_mutex;
+            std::lock_guard<Mutex_t> output_lock(output_mutex);
+            for (const Trace_record_t &record : printed)
+                format_trace_record(record, [](const char *part, std::size_t size) {
+                    std::cerr.write(part, size);
+                });
+            std::cerr.flush();
+        }
+
+        // Function writes records of buffer straight to standard error, without locks and streams,
+        // which could be held or broken by the thread that got signal. Buffer of thread
+        // running at the same time may lose records it was adding.
+        void print_on_signal() const {
+            const std::size_t count = records_count.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < count; i++)
+                format_trace_record(records[i], [](const char *part, std::size_t size) {
+                    while (size > 0) {
+                        const ssize_t written = ::write(STDERR_FILENO, part, size);
+                        if (written <= 0)
+                            return;
+                        part += written;
+                        size -= written;
+                    }
+                });
+        }
+
+        static std::array<struct sigaction, FATAL_SIGNALS.size()> &previous_actions() {
+            static std::array<struct sigaction, FATAL_SIGNALS.size()> actions;
+            return actions;
+        }
+
+        static bool install_signal_handlers() {
+            if constexpr (!sync_trace) {
+                struct sigaction action{};
+                action.sa_handler = handle_signal;
+                sigemptyset(&action.sa_mask);
+                for (std::size_t i = 0; i < FATAL_SIGNALS.size(); i++)
+                    sigaction(FATAL_SIGNALS[i], &action, &previous_actions()[i]);
+            }
+            return true;
+        }
+
+        // Function prints buffers of calling thread and of the others and raises signal again with handler
+        // that was set before, so program ends as it would without tracing.
+        static void handle_signal(int signal_number) {
+            static std::atomic<bool> is_printed{false};
+            if (!is_printed.exchange(true)) {
+                if (current_trace_buffer != nullptr)
+                    current_trace_buffer->print_on_signal();
+                for (auto &buffer : trace_buffers) {
+                    const Trace_buffer_t *other = buffer.load();
+                    if (other != nullptr && other != current_trace_buffer)
+                        other->print_on_signal();
+                }
+            }
+
+            for (std::size_t i = 0; i < FATAL_SIGNALS.size(); i++)
+                if (FATAL_SIGNALS[i] == signal_number)
+                    sigaction(signal_number, &previous_actions()[i], nullptr);
+            raise(signal_number);
+        }
+
+        std::array<Trace_record_t, MAX_RECORDS> records;
+        std::array<char, MAX_TEXT> text;
+        std::atomic<std::size_t> records_count{0};
+        std::size_t text_size = 0;
+        bool is_closed = false;
+    };
+
+    static thread_local Trace_buffer_t trace_buffer;
+
+    static Trace_record_t trace_record(Trace_kind_t kind, const char *function_name,
+                                       std::initializer_list<Id_t> values = {}) {
+        Trace_record_t record{};
+        record.function_name = function_name;
+        record.kind = kind;
+        std::copy(values.begin(), values.end(), record.values.begin());
+        record.values_count = values.size();
+        return record;
+    }
+
+    static void set_trace_text(Trace_record_t &record, const char *str) {
+        if (str == nullptr) {
+            record.text_type = Trace_text_t::null;
+        } else {
+            record.text_type = Trace_text_t::string;
+            record.text = str;
+            record.text_length = std::strlen(str);
+        }
+    }
+
+    // Function records function name and it's parameters.
+    static void debug_function_call_arguments(const char *function_name, std::initializer_list<Id_t> arguments) {
+        trace_buffer.add(trace_record(Trace_kind_t::arguments, function_name, arguments));
+    }
+
+    static void debug_function_call_arguments(const char *function_name, std::initializer_list<Id_t> arguments,
+                                              const char *str) {
+        Trace_record_t record = trace_record(Trace_kind_t::arguments, function_name, arguments);
+        set_trace_text(record, str);
+        trace_buffer.add(record);
+    }
+
+    // Function records the result of the function.
+    static void debug_function_call_result(const char *function_name, const char *result) {
+        Trace_record_t record = trace_record(Trace_kind_t::result, function_name);
+        set_trace_text(record, result);
+        trace_buffer.add(record);
+    }
+
+    static void debug_function_call_result(const char *function_name, const Id_t result) {
+        trace_buffer.add(trace_record(Trace_kind_t::result, function_name, {result}));
+    }
+
+    static void debug_function_call_result(const char *function_name, const int32_t result) {
+        Trace_record_t record = trace_record(Trace_kind_t::result, function_name, {static_cast<Id_t>(result)});
+        record.is_signed = true;
+        trace_buffer.add(record);
+    }
+
+    static void debug_function_call_result(const char *function_name) {
+        Trace_record_t record = trace_record(Trace_kind_t::result, function_name);
+        set_trace_text(record, nullptr);
+        trace_buffer.add(record);
+    }
+
+    // Function records if function is done or if it failed.
+    static void debug_function_call_execution_status(const char *function_name, const char *status) {
+        Trace_record_t record = trace_record(Trace_kind_t::status, function_name);
+        record.status = status;
+        trace_buffer.add(record);
+    }
 
-        std::cerr << ")" << std::endl;
+    // Function records that queue with such id does not exist.
+    static void debug_function_call_queue_not_found(const char *function_name, Id_t id) {
+        trace_buffer.add(trace_record(Trace_kind_t::queue_not_found, function_name, {id}));
     }
 
-    // Function prints the result of the function.
-    static void debug_function_call_result(const std::string &function_name,
-                                           const std::string &result) {
-        std::cerr << function_name << " returns " << "\"" << result << "\"" << std::endl;
+    // Function records that queue with given id does not have element at given position.
+    static void debug_function_call_not_existing_element(const char *function_name, Id_t id,
+                                                         std::size_t position) {
+        trace_buffer.add(trace_record(Trace_kind_t::not_existing_element, function_name, {id, position}));
     }
 
-    static void debug_function_call_result(const std::string &function_name,
-                                           const Id_t result) {
-        std::cerr << function_name << " returns " << result << std::endl;
+    // Function writes record of operation to journal, if it's open. Returns false if record can't be written,
+    // then operation must not be done.
+    static bool write_to_journal(Journal_t::Operation_t operation, std::initializer_list<std::uint64_t> values,
+                                 const char *const *strs = nullptr, std::size_t count = 0,
+                                 const char **stored = nullptr) {
+        return !journal().is_open() || journal().append(operation, values, strs, count, stored);
+    }
+
+    // Function removes queue from its locked slot and moves slot to the next generation.
+    // Returns removed queue and sets is_retired if slot can't be used anymore.
+    static std::unique_ptr<Queue_t> take_queue(Slot_t &slot, bool &is_retired) {
+        // Slot whose generation would overflow is never used again, so its ids can't repeat.
+        const Id_t generation = slot.id >> SLOT_BITS;
+        is_retired = generation == LAST_GENERATION;
+        slot.id = is_retired ? ~Id_t{0} : ((generation + 1) << SLOT_BITS) | (slot.id & SLOT_MASK);
+        return std::move(slot.queue);
+    }
+
+    // Function creates new queue in free slot and returns it's id.
+    // If all slots are used or its creation can't be written to journal returns NO_QUEUE.
+    static Id_t create_queue() {
+        Registry_t &queues = registry();
+        Id_t slot_index = 0;
+        bool is_reused = false;
+        {
+            std::lock_guard<Mutex_t> free_slots_lock(queues.free_slots_mutex);
+            if (!queues.free_slots.empty()) {
+                slot_index = queues.free_slots.back();
+                queues.free_slots.pop_back();
+                is_reused = true;
+            }
+        }
+        if (!is_reused) {
+            // Counter stops at the number of slots, so it can't wrap around to slots that are in use.
+            slot_index = queues.next_slot.load(std::memory_order_relaxed);
+            do {
+                if (slot_index == SLOTS_COUNT)
+                    return NO_QUEUE;
+            } while (!queues.next_slot.compare_exchange_weak(slot_index, slot_index + 1, std::memory_order_relaxed));
+        }
+
+        Slot_t *slot = slot_at(slot_index, true);
+        std::lock_guard<Mutex_t> slot_lock(slot->mutex);
+        if (!write_to_journal(Journal_t::Operation_t::create, {slot->id})) {
+            std::lock_guard<Mutex_t> free_slots_lock(queues.free_slots_mutex);
+            queues.free_slots.push_back(slot_index);
+            return NO_QUEUE;
+        }
+        slot->queue = std::make_unique<Queue_t>(journal().is_open());
+        return slot->id;
+    }
+
+    // Function applies operation from record of journal to queues. Records were checked when journal was opened,
+    // so they have all values of their operations and slots of created queues and free slots are valid.
+    static void replay(const Journal_t::Record_t &record) {
+        const Id_t id = record.values[0];
+        switch (record.operation) {
+            case Journal_t::Operation_t::create: {
+                Registry_t &queues = registry();
+                Slot_t *slot = slot_at(id & SLOT_MASK, true);
+                slot->id = id;
+                slot->queue = std::make_unique<Queue_t>(true);
+                if (queues.next_slot.load(std::memory_order_relaxed) <= (id & SLOT_MASK))
+                    queues.next_slot.store((id & SLOT_MASK) + 1, std::memory_order_relaxed);
+                break;
+            }
+            case Journal_t::Operation_t::free_slot: {
+                Registry_t &queues = registry();
+                const Id_t slot_index = record.values[0];
+                Slot_t *slot = slot_at(slot_index, true);
+                slot->id = record.values[1];
+                slot->queue.reset();
+                if (queues.next_slot.load(std::memory_order_relaxed) <= slot_index)
+                    queues.next_slot.store(slot_index + 1, std::memory_order_relaxed);
+                break;
+            }
+            case Journal_t::Operation_t::erase_queue: {
+                Slot_t *slot = slot_at(id & SLOT_MASK, false);
+                bool is_retired;
+                if (slot != nullptr && slot->id == id)
+                    take_queue(*slot, is_retired);
+                break;
+            }
+            case Journal_t::Operation_t::clone: {
+                auto [queue, clone] = find_queues(id, record.values[1]);
+                if (queue != nullptr && clone != nullptr)
+                    queue->share(*clone);
+                break;
+            }
+            default: {
+                auto queue = find_queue(id);
+                if (queue == nullptr)
+                    break;
+                if (record.operation == Journal_t::Operation_t::insert)
+                    queue->insert_journaled(record.values[1], record.first_str, record.strings_count);
+                else if (record.operation == Journal_t::Operation_t::erase && record.values[1] < queue->size())
+                    queue->erase(record.values[1]);
+                else if (record.operation == Journal_t::Operation_t::erase_range && record.values[1] < queue->size())
+                    queue->erase(record.values[1], record.values[2]);
+                else if (record.operation == Journal_t::Operation_t::clear)
+                    queue->clear();
+                break;
+            }
+        }
     }
 
-    static void debug_function_call_result(const std::string &function_name,
-                                           const int32_t result) {
-        std::cerr << function_name << " returns " << result << std::endl;
+    // Journal is written again when its records take more than this many times the space of their result.
+    constexpr std::size_t CHECKPOINT_RATIO = 2;
+    // Smaller journals are never written again.
+    constexpr std::size_t CHECKPOINT_MIN_SIZE = 1 << 20;
+    // Maximal number of strings in one record of checkpoint.
+    constexpr std::size_t CHECKPOINT_STRINGS = 1 << 16;
+
+    // Function locks all slots used so far, in order of their indexes, and returns their locks.
+    static std::vector<std::unique_lock<Mutex_t>> lock_all_slots() {
+        std::vector<std::unique_lock<Mutex_t>> locks;
+        const Id_t slots_count = registry().next_slot.load(std::memory_order_acquire);
+        locks.reserve(slots_count);
+        for (Id_t slot_index = 0; slot_index < slots_count; slot_index++)
+            locks.emplace_back(slot_at(slot_index, true)->mutex);
+        return locks;
     }
 
-    static void debug_function_call_result(const std::string &function_name) {
-        std::cerr << function_name << " returns " << "NULL" << std::endl;
+    // Function returns size of journal which would hold only records of queues and slots whose locks are given.
+    static std::size_t checkpoint_size(const std::vector<std::unique_lock<Mutex_t>> &locks) {
+        std::size_t size = 0;
+        std::vector<const char *> strs;
+        for (Id_t slot_index = 0; slot_index < locks.size(); slot_index++) {
+            const Queue_t *queue = slot_at(slot_index, false)->queue.get();
+            if (queue == nullptr) {
+                size += Journal_t::record_size(2, 0);
+                continue;
+            }
+
+            strs.resize(queue->size());
+            queue->copy(0, strs.size(), strs.data());
+            size += Journal_t::record_size(1, 0) +
+                    (strs.size() + CHECKPOINT_STRINGS - 1) / CHECKPOINT_STRINGS * Journal_t::record_size(2, 0);
+            for (const char *str : strs)
+                size += String_store_t::entry_size(String_store_t::length(str));
+        }
+        return size;
     }
 
-    // Function prints if function is done or if it failed.
-    static void debug_function_call_execution_status(
-        const std::string &function_name, const std::string &status) {
-        std::cerr << function_name << " " << status << std::endl;
+    // Function writes journal again as creation of each queue with its strings, in parts of at most
+    // CHECKPOINT_STRINGS, and ids of free slots, if it's worth it. Slots are locked, so no operation is written
+    // to the old file after their records are written. Operations on queues created later wait for journal.
+    // Returns true if journal was written again.
+    static bool checkpoint_journal() {
+        const auto locks = lock_all_slots();
+        if (journal().size() <= std::max(CHECKPOINT_MIN_SIZE, CHECKPOINT_RATIO * checkpoint_size(locks)))
+            return false;
+
+        return journal().checkpoint([&locks](Journal_t &written) {
+            std::vector<const char *> strs;
+            for (Id_t slot_index = 0; slot_index < locks.size(); slot_index++) {
+                const Slot_t *slot = slot_at(slot_index, false);
+                if (slot->queue == nullptr) {
+                    if (!written.append(Journal_t::Operation_t::free_slot, {slot_index, slot->id}))
+                        return false;
+                    continue;
+                }
+
+                if (!written.append(Journal_t::Operation_t::create, {slot->id}))
+                    return false;
+                strs.resize(slot->queue->size());
+                slot->queue->copy(0, strs.size(), strs.data());
+                for (std::size_t first = 0; first < strs.size(); first += CHECKPOINT_STRINGS) {
+                    const std::size_t count = std::min(CHECKPOINT_STRINGS, strs.size() - first);
+                    if (!written.append(Journal_t::Operation_t::insert, {slot->id, first}, strs.data() + first, count))
+                        return false;
+                }
+            }
+            return true;
+        });
     }
 
-    // Function prints that queue with such id does not exist.
-    static void debug_function_call_queue_not_found(
-        const std::string &function_name, Id_t id) {
-        std::cerr << function_name << ": queue " << id << " does not exist" << std::endl;
+    // Journal is written again at exit, so it's opened next time in time proportional to size of queues.
+    static void checkpoint_journal_at_exit() {
+        checkpoint_journal();
     }
 
-    // Function prints at queue with given id does not have element at given position.
-    static void debug_function_call_not_existing_element(
-        const std::string &function_name, Id_t id, std::size_t position) {
-        std::cerr << function_name << ": queue " << id
-                << " does not contain string at position " << position << std::endl;
+    // Function makes queues persistent in file at given path. Queues kept there are restored and all later
+    // changes are written to it. File is compacted when it's opened and at exit, if it holds much more
+    // history of operations than queues. Returns 0 on success and -1 if the file can't be used or any queue was created
+    // before, then nothing changes.
+    int strqueue_open(const char *path) {
+        if constexpr (debug)
+            debug_function_call_arguments(__func__, {}, path);
+
+        Registry_t &queues = registry();
+        if (path == nullptr || journal().is_open() || queues.next_slot.load(std::memory_order_relaxed) != 0 ||
+            !journal().open(path, replay)) {
+            if constexpr (debug)
+                debug_function_call_result(__func__, -1);
+            return -1;
+        }
+
+        // Journal whose history is much longer than its result is written again. Queues are then restored from
+        // the new file, so nothing points to the old one and it can be unmapped.
+        if (checkpoint_journal()) {
+            journal().replay(replay);
+            journal().unmap_replaced();
+        }
+        std::atexit(checkpoint_journal_at_exit);
+
+        // Slots without queues, including the ones whose creation was not written, are free.
+        std::lock_guard<Mutex_t> free_slots_lock(queues.free_slots_mutex);
+        for (Id_t slot_index = queues.next_slot.load(std::memory_order_relaxed); slot_index-- > 0;) {
+            Slot_t *slot = slot_at(slot_index, true);
+            if (slot->queue == nullptr && slot->id != ~Id_t{0})
+                queues.free_slots.push_back(slot_index);
+        }
+
+        if constexpr (debug)
+            debug_function_call_result(__func__, 0);
+        return 0;
     }
 
     // Function creates new queue and returns it's id.
     Id_t strqueue_new() {
-        static Id_t number_of_queues = 0;
         if constexpr (debug)
-            debug_function_call_arguments(__func__, std::vector<Id_t>{});
+            debug_function_call_arguments(__func__, {});
 
-        map_of_queues()[number_of_queues] = std::deque<std::string>();
-        number_of_queues++;
+        const Id_t id = create_queue();
 
         if constexpr (debug)
-            debug_function_call_result(__func__, number_of_queues - 1);
+            debug_function_call_result(__func__, id);
 
-        return number_of_queues - 1;
+        return id;
     }
 
     // Function deletes queue with given id, otherwise does nothing.
     void strqueue_delete(Id_t id) {
         if constexpr (debug)
-            debug_function_call_arguments(__func__, std::vector<Id_t>{id});
+            debug_function_call_arguments(__func__, {id});
+
+        Slot_t *slot = slot_at(id & SLOT_MASK, false);
+        bool is_deleted = false;
+        bool is_retired = false;
+        std::unique_ptr<Queue_t> deleted_queue;
+        if (slot != nullptr) {
+            std::lock_guard<Mutex_t> slot_lock(slot->mutex);
+            if (slot->id == id && slot->queue != nullptr) {
+                if (!write_to_journal(Journal_t::Operation_t::erase_queue, {id})) {
+                    if constexpr (debug)
+                        debug_function_call_execution_status(__func__, "failed");
+                    return;
+                }
+                deleted_queue = take_queue(*slot, is_retired);
+                is_deleted = true;
+            }
+        }
 
-        auto found_queue_iterator = find_queue(id);
-        if (found_queue_iterator != nullptr) {
-            map_of_queues().erase(id);
+        if (is_deleted) {
+            // Queue is freed after its slot is unlocked.
+            deleted_queue.reset();
+            if (!is_retired) {
+                Registry_t &queues = registry();
+                std::lock_guard<Mutex_t> free_slots_lock(queues.free_slots_mutex);
+                queues.free_slots.push_back(id & SLOT_MASK);
+            }
             if constexpr (debug)
                 debug_function_call_execution_status(__func__, "done");
             return;
@@ -141,7 +2045,7 @@ namespace cxx {
     // Function returns size of queue with given id.
     std::size_t strqueue_size(Id_t id) {
         if constexpr (debug)
-            debug_function_call_arguments(__func__, std::vector<Id_t>{id});
+            debug_function_call_arguments(__func__, {id});
 
         auto queue = find_queue(id);
 
@@ -164,7 +2068,7 @@ namespace cxx {
     // If size of queue is smaller than position it places string at the end of queue.
     void strqueue_insert_at(Id_t id, std::size_t position, const char *str) {
         if constexpr (debug)
-            debug_function_call_arguments(__func__, std::vector<Id_t>{id, position}, str);
+            debug_function_call_arguments(__func__, {id, position}, str);
 
         auto queue = find_queue(id);
         if (queue == nullptr) {
@@ -179,14 +2083,27 @@ namespace cxx {
             return;
         }
 
+        if (journal().is_open()) {
+            const char *stored;
+            if (!journal().append(Journal_t::Operation_t::insert, {id, position}, &str, 1, &stored)) {
+                if constexpr (debug)
+                    debug_function_call_execution_status(__func__, "failed");
+                return;
+            }
+            queue->insert_journaled(position, stored, 1);
+            if constexpr (debug)
+                debug_function_call_execution_status(__func__, "done");
+            return;
+        }
+
         if (position >= queue->size()) {
-            queue->emplace_back(str);
+            queue->push_back(str);
             if constexpr (debug)
                 debug_function_call_execution_status(__func__, "done");
             return;
         }
 
-        queue->emplace(queue->begin() + position, str);
+        queue->insert(position, str);
         if constexpr (debug)
             debug_function_call_execution_status(__func__, "done");
     }
@@ -195,7 +2112,7 @@ namespace cxx {
     // If given queue does not exist or there is no such position in that queue does nothing.
     void strqueue_remove_at(Id_t id, std::size_t position) {
         if constexpr (debug)
-            debug_function_call_arguments(__func__, std::vector<Id_t>{id, position});
+            debug_function_call_arguments(__func__, {id, position});
 
         auto queue = find_queue(id);
         if (queue == nullptr) {
@@ -205,7 +2122,12 @@ namespace cxx {
         }
 
         if (position < queue->size()) {
-            queue->erase(queue->begin() + position, queue->begin() + position + 1);
+            if (!write_to_journal(Journal_t::Operation_t::erase, {id, position})) {
+                if constexpr (debug)
+                    debug_function_call_execution_status(__func__, "failed");
+                return;
+            }
+            queue->erase(position);
             if constexpr (debug)
                 debug_function_call_execution_status(__func__, "done");
         } else if constexpr (debug)
@@ -216,7 +2138,7 @@ namespace cxx {
     // If there is no such element or given queue does not exist returns NULL.
     const char *strqueue_get_at(Id_t id, std::size_t position) {
         if constexpr (debug)
-            debug_function_call_arguments(__func__, std::vector<Id_t>{id, position});
+            debug_function_call_arguments(__func__, {id, position});
 
         auto queue = find_queue(id);
         if (queue == nullptr) {
@@ -237,13 +2159,13 @@ namespace cxx {
 
         if constexpr (debug)
             debug_function_call_result(__func__, queue->at(position));
-        return queue->at(position).c_str();
+        return queue->at(position);
     }
 
     // Function clears queue with given id.
     void strqueue_clear(Id_t id) {
         if constexpr (debug)
-            debug_function_call_arguments(__func__, std::vector<Id_t>{id});
+            debug_function_call_arguments(__func__, {id});
         auto queue = find_queue(id);
         if (queue == nullptr) {
             if constexpr (debug)
@@ -251,19 +2173,149 @@ namespace cxx {
             return;
         }
 
+        if (!write_to_journal(Journal_t::Operation_t::clear, {id})) {
+            if constexpr (debug)
+                debug_function_call_execution_status(__func__, "failed");
+            return;
+        }
         queue->clear();
         if constexpr (debug)
             debug_function_call_execution_status(__func__, "done");
     }
 
+    // Function inserts count strings from array strs to queue with given id before given position.
+    // Null strings are skipped. If strs is null or queue doesn't exist does nothing.
+    // If size of queue is smaller than position it places strings at the end of queue.
+    void strqueue_insert_many(Id_t id, std::size_t position, const char *const *strs, std::size_t count) {
+        if constexpr (debug)
+            debug_function_call_arguments(__func__, {id, position, count});
+
+        auto queue = find_queue(id);
+        if (queue == nullptr) {
+            if constexpr (debug)
+                debug_function_call_queue_not_found(__func__, id);
+            return;
+        }
+
+        if (strs == nullptr) {
+            if constexpr (debug)
+                debug_function_call_execution_status(__func__, "failed");
+            return;
+        }
+
+        if (journal().is_open()) {
+            const char *stored = nullptr;
+            if (!journal().append(Journal_t::Operation_t::insert, {id, position}, strs, count, &stored)) {
+                if constexpr (debug)
+                    debug_function_call_execution_status(__func__, "failed");
+                return;
+            }
+            if (stored != nullptr)
+                queue->insert_journaled(position, stored, std::count_if(strs, strs + count, [](const char *str) {
+                    return str != nullptr;
+                }));
+        } else {
+            queue->insert(position, strs, count);
+        }
+        if constexpr (debug)
+            debug_function_call_execution_status(__func__, "done");
+    }
+
+    // Function removes at most count elements starting from given position from queue with given id.
+    // If given queue does not exist or there is no such position in that queue does nothing.
+    void strqueue_remove_range(Id_t id, std::size_t position, std::size_t count) {
+        if constexpr (debug)
+            debug_function_call_arguments(__func__, {id, position, count});
+
+        auto queue = find_queue(id);
+        if (queue == nullptr) {
+            if constexpr (debug)
+                debug_function_call_queue_not_found(__func__, id);
+            return;
+        }
+
+        if (position < queue->size()) {
+            if (!write_to_journal(Journal_t::Operation_t::erase_range, {id, position, count})) {
+                if constexpr (debug)
+                    debug_function_call_execution_status(__func__, "failed");
+                return;
+            }
+            queue->erase(position, count);
+            if constexpr (debug)
+                debug_function_call_execution_status(__func__, "done");
+        } else if constexpr (debug)
+            debug_function_call_not_existing_element(__func__, id, position);
+    }
+
+    // Function writes to strs pointers to at most count elements starting from given position
+    // in given queue and returns their number.
+    // If there is no such element, given queue does not exist or strs is null returns 0.
+    std::size_t strqueue_get_range(Id_t id, std::size_t position, std::size_t count, const char **strs) {
+        if constexpr (debug)
+            debug_function_call_arguments(__func__, {id, position, count});
+
+        auto queue = find_queue(id);
+        if (queue == nullptr) {
+            if constexpr (debug) {
+                debug_function_call_queue_not_found(__func__, id);
+                debug_function_call_result(__func__, 0);
+            }
+            return 0;
+        }
+
+        if (queue->size() <= position) {
+            if constexpr (debug) {
+                debug_function_call_not_existing_element(__func__, id, position);
+                debug_function_call_result(__func__, 0);
+            }
+            return 0;
+        }
+
+        const std::size_t copied = strs == nullptr ? 0 : queue->copy(position, count, strs);
+        if constexpr (debug)
+            debug_function_call_result(__func__, copied);
+        return copied;
+    }
+
+    // Function creates new queue with the same strings as queue with given id and returns it's id.
+    // If queue with such id does not exist new queue is empty.
+    Id_t strqueue_clone(Id_t id) {
+        if constexpr (debug)
+            debug_function_call_arguments(__func__, {id});
+
+        Id_t clone_id = create_queue();
+        bool is_failed = false;
+        {
+            auto [queue, clone] = find_queues(id, clone_id);
+            if (queue == nullptr) {
+                if constexpr (debug)
+                    debug_function_call_queue_not_found(__func__, id);
+            } else if (clone != nullptr) {
+                if (write_to_journal(Journal_t::Operation_t::clone, {id, clone_id}))
+                    queue->share(*clone);
+                else
+                    is_failed = true;
+            }
+        }
+
+        // Clone which would be restored from journal as empty queue is deleted.
+        if (is_failed) {
+            strqueue_delete(clone_id);
+            clone_id = NO_QUEUE;
+        }
+
+        if constexpr (debug)
+            debug_function_call_result(__func__, clone_id);
+        return clone_id;
+    }
+
     // Function compares two queues lexicographically.
     // If queue with such id does not exist it's treated as empty queue.
     int strqueue_comp(Id_t id1, Id_t id2) {
         if constexpr (debug)
-            debug_function_call_arguments(__func__, std::vector<Id_t>{id1, id2});
+            debug_function_call_arguments(__func__, {id1, id2});
 
-        auto queue_1 = find_queue(id1);
-        auto queue_2 = find_queue(id2);
+        auto [queue_1, queue_2] = find_queues(id1, id2);
 
         if (queue_1 == nullptr && queue_2 == nullptr) {
             if constexpr (debug)
@@ -305,13 +2357,14 @@ namespace cxx {
             return 1;
         }
 
-        if (*queue_1 > *queue_2) {
+        const std::strong_ordering order = *queue_1 <=> *queue_2;
+        if (order > 0) {
             if constexpr (debug)
                 debug_function_call_result(__func__, 1);
             return 1;
         }
 
-        if (*queue_2 > *queue_1) {
+        if (order < 0) {
             if constexpr (debug)
                 debug_function_call_result(__func__, -1);
             return -1;
@@ -320,4 +2373,32 @@ namespace cxx {
             debug_function_call_result(__func__, 0);
         return 0;
     }
+
+    // Function returns 1 if queues have the same strings and 0 otherwise. Queues of different sizes, or with
+    // content hashes different queues, are told apart in constant time. If queue with such id does not exist
+    // it's treated as empty queue.
+    int strqueue_equal(Id_t id1, Id_t id2) {
+        if constexpr (debug)
+            debug_function_call_arguments(__func__, {id1, id2});
+
+        auto [queue_1, queue_2] = find_queues(id1, id2);
+        if (queue_1 == nullptr) {
+            if constexpr (debug)
+                debug_function_call_queue_not_found(__func__, id1);
+        }
+        if (queue_2 == nullptr) {
+            if constexpr (debug)
+                debug_function_call_queue_not_found(__func__, id2);
+        }
+
+        int is_equal;
+        if (queue_1 == nullptr || queue_2 == nullptr)
+            is_equal = (queue_1 == nullptr || queue_1->empty()) && (queue_2 == nullptr || queue_2->empty());
+        else
+            is_equal = *queue_1 == *queue_2;
+
+        if constexpr (debug)
+            debug_function_call_result(__func__, is_equal);
+        return is_equal;
+    }
 }
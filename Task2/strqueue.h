@@ -18,6 +18,12 @@ void strqueue_remove_at(unsigned long id, size_t position);
 const char* strqueue_get_at(unsigned long id, size_t position);
 void strqueue_clear(unsigned long id);
 int strqueue_comp(unsigned long id1, unsigned long id2);
+int strqueue_equal(unsigned long id1, unsigned long id2);
+void strqueue_insert_many(unsigned long id, size_t position, const char* const* strs, size_t count);
+void strqueue_remove_range(unsigned long id, size_t position, size_t count);
+size_t strqueue_get_range(unsigned long id, size_t position, size_t count, const char** strs);
+unsigned long strqueue_clone(unsigned long id);
+int strqueue_open(const char* path);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,114 @@
+// Test of strqueue_comp and strqueue_equal against comparison of vectors of strings, on long queues
+// which are equal, differ in one string or in size, and on clones changed after cloning.
+// Build it with and without STRQUEUE_CONTENT_HASH, see comparison_test.sh.
+// Usage: comparison_test [seed]
+
+#include "../strqueue.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    using namespace cxx;
+
+    std::mt19937_64 generator;
+    std::size_t failures = 0;
+
+    std::size_t random_below(std::size_t bound) {
+        return std::uniform_int_distribution<std::size_t>(0, bound - 1)(generator);
+    }
+
+    // Queue together with its expected strings.
+    struct Checked_queue_t {
+        unsigned long id;
+        std::vector<std::string> strings;
+    };
+
+    Checked_queue_t make_queue(const std::vector<std::string> &strings) {
+        Checked_queue_t queue{strqueue_new(), strings};
+        for (std::size_t position = 0; position < strings.size(); position++)
+            strqueue_insert_at(queue.id, position, strings[position].c_str());
+        return queue;
+    }
+
+    Checked_queue_t clone_queue(const Checked_queue_t &queue) {
+        return {strqueue_clone(queue.id), queue.strings};
+    }
+
+    void replace(Checked_queue_t &queue, std::size_t position, const std::string &str) {
+        strqueue_remove_at(queue.id, position);
+        strqueue_insert_at(queue.id, position, str.c_str());
+        queue.strings[position] = str;
+    }
+
+    void check(const Checked_queue_t &queue_1, const Checked_queue_t &queue_2) {
+        const int expected = queue_1.strings < queue_2.strings ? -1 : queue_2.strings < queue_1.strings ? 1 : 0;
+        if (strqueue_comp(queue_1.id, queue_2.id) != expected || strqueue_comp(queue_2.id, queue_1.id) != -expected ||
+            strqueue_equal(queue_1.id, queue_2.id) != (expected == 0)) {
+            if (failures++ < 10)
+                std::fprintf(stderr, "FAILED: queues %lu and %lu, expected %d\n", queue_1.id, queue_2.id, expected);
+        }
+    }
+
+    std::vector<std::string> random_strings(std::size_t count) {
+        static const std::vector<std::string> words = {"", "a", "ab", "abc", "b", "ba", "long string of text"};
+        std::vector<std::string> strings(count);
+        for (auto &str : strings)
+            str = words[random_below(words.size())];
+        return strings;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    generator.seed(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1);
+
+    for (std::size_t round = 0; round < 50; round++) {
+        const std::size_t size = 1 + random_below(round < 25 ? 100 : 5000);
+        const std::vector<std::string> strings = random_strings(size);
+        Checked_queue_t queue = make_queue(strings);
+        Checked_queue_t copy = make_queue(strings);
+        Checked_queue_t clone = clone_queue(queue);
+        check(queue, copy);
+        check(queue, clone);
+
+        // Single string is changed at the front, in the middle or at the end.
+        for (std::size_t position : {std::size_t{0}, size / 2, size - 1}) {
+            const std::string original = copy.strings[position];
+            replace(copy, position, original + "x");
+            check(queue, copy);
+            replace(clone, position, original.empty() ? "a" : original.substr(1));
+            check(queue, clone);
+            check(copy, clone);
+            replace(copy, position, original);
+            replace(clone, position, original);
+            check(queue, copy);
+            check(queue, clone);
+        }
+
+        // One queue is a prefix of the other.
+        strqueue_insert_at(copy.id, size, "");
+        copy.strings.push_back("");
+        check(queue, copy);
+
+        // Missing queue is equal only to empty ones.
+        const Checked_queue_t missing{strqueue_new(), {}};
+        strqueue_delete(missing.id);
+        check(queue, missing);
+        strqueue_remove_range(clone.id, 0, size);
+        clone.strings.clear();
+        check(clone, missing);
+
+        for (const Checked_queue_t *checked : {&queue, &copy, &clone})
+            strqueue_delete(checked->id);
+    }
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%zu checks failed\n", failures);
+        return 1;
+    }
+    std::printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,18 @@
+#!/bin/sh
+# Runs test of comparison of queues built with and without content hashes.
+# Usage: tests/comparison_test.sh
+set -eu
+
+cd "$(dirname "$0")/.."
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+CXX=${CXX:-g++}
+FLAGS="-std=c++20 -O2 -Wall -Wextra -DNDEBUG"
+$CXX $FLAGS tests/comparison_test.cpp strqueue.cpp -o "$work/test"
+$CXX $FLAGS -DSTRQUEUE_CONTENT_HASH tests/comparison_test.cpp strqueue.cpp -o "$work/test_hash"
+
+for seed in 1 2 3; do
+    "$work/test" "$seed"
+    "$work/test_hash" "$seed"
+done
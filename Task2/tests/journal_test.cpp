@@ -0,0 +1,159 @@
+// Test of queues kept in journal across restarts. Each run opens the journal, checks queues against the state
+// written by the previous run, changes them many times, deletes, creates and clones queues, and writes the
+// new state. Journal is compacted at exit, so its size has to stay bounded, see journal_test.sh.
+// Usage: journal_test journal_file state_file seed [number_of_operations]
+
+#include "../strqueue.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+    using namespace cxx;
+
+    constexpr std::size_t NUMBER_OF_QUEUES = 8;
+    constexpr std::size_t MAX_QUEUE_SIZE = 64;
+
+    std::mt19937_64 generator;
+    std::size_t failures = 0;
+
+    std::size_t random_below(std::size_t bound) {
+        return std::uniform_int_distribution<std::size_t>(0, bound - 1)(generator);
+    }
+
+    std::string random_string() {
+        std::string str(random_below(1000), 'a');
+        for (char &c : str)
+            c = static_cast<char>('a' + random_below(26));
+        return str;
+    }
+
+    // Expected queues and ids of all queues deleted so far.
+    struct State_t {
+        std::map<unsigned long, std::vector<std::string>> queues;
+        std::set<unsigned long> deleted;
+    };
+
+    // State is kept as lines "queue id size" followed by strings and lines "deleted id".
+    State_t read_state(const char *path) {
+        State_t state;
+        std::ifstream file(path);
+        std::string kind;
+        unsigned long id;
+        while (file >> kind >> id) {
+            if (kind == "deleted") {
+                state.deleted.insert(id);
+                continue;
+            }
+            std::size_t size;
+            file >> size;
+            file.ignore();
+            auto &strings = state.queues[id];
+            strings.resize(size);
+            for (auto &str : strings)
+                std::getline(file, str);
+        }
+        return state;
+    }
+
+    void write_state(const char *path, const State_t &state) {
+        std::ofstream file(path, std::ios::trunc);
+        for (const auto &[id, strings] : state.queues) {
+            file << "queue " << id << ' ' << strings.size() << '\n';
+            for (const auto &str : strings)
+                file << str << '\n';
+        }
+        for (unsigned long id : state.deleted)
+            file << "deleted " << id << '\n';
+    }
+
+    void check(const State_t &state) {
+        for (const auto &[id, strings] : state.queues) {
+            bool is_correct = strqueue_size(id) == strings.size();
+            for (std::size_t position = 0; is_correct && position < strings.size(); position++)
+                is_correct = strqueue_get_at(id, position) == strings[position];
+            if (!is_correct && failures++ < 10)
+                std::fprintf(stderr, "FAILED: queue %lu isn't restored\n", id);
+        }
+        for (unsigned long id : state.deleted) {
+            if (strqueue_size(id) != 0 && failures++ < 10)
+                std::fprintf(stderr, "FAILED: deleted queue %lu is restored\n", id);
+        }
+    }
+
+    void add_queue(State_t &state, unsigned long id) {
+        if ((state.queues.count(id) != 0 || state.deleted.count(id) != 0) && failures++ < 10)
+            std::fprintf(stderr, "FAILED: id %lu is repeated\n", id);
+        state.queues[id];
+    }
+
+    void change(State_t &state, std::size_t number_of_operations) {
+        while (state.queues.size() < NUMBER_OF_QUEUES)
+            add_queue(state, strqueue_new());
+
+        for (std::size_t i = 0; i < number_of_operations; i++) {
+            auto queue = std::next(state.queues.begin(), random_below(state.queues.size()));
+            const unsigned long id = queue->first;
+            auto &strings = queue->second;
+            const std::size_t kind = random_below(1000);
+            if (kind == 0) {
+                strqueue_delete(id);
+                state.queues.erase(queue);
+                state.deleted.insert(id);
+                add_queue(state, strqueue_new());
+            }
+            else if (kind == 1) {
+                const unsigned long clone = strqueue_clone(id);
+                const auto copied = strings;
+                add_queue(state, clone);
+                state.queues[clone] = copied;
+                const auto oldest = state.queues.begin();
+                strqueue_delete(oldest->first);
+                state.deleted.insert(oldest->first);
+                state.queues.erase(oldest);
+            }
+            else if (strings.size() < MAX_QUEUE_SIZE && kind % 2 == 0) {
+                const std::size_t position = random_below(strings.size() + 1);
+                const std::string str = random_string();
+                strqueue_insert_at(id, position, str.c_str());
+                strings.insert(strings.begin() + position, str);
+            }
+            else if (!strings.empty()) {
+                const std::size_t position = random_below(strings.size());
+                strqueue_remove_at(id, position);
+                strings.erase(strings.begin() + position);
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 4) {
+        std::fprintf(stderr, "Usage: %s journal_file state_file seed [number_of_operations]\n", argv[0]);
+        return 1;
+    }
+    generator.seed(std::strtoull(argv[3], nullptr, 10));
+    const std::size_t number_of_operations = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 200000;
+
+    if (strqueue_open(argv[1]) != 0) {
+        std::fprintf(stderr, "FAILED: journal %s can't be opened\n", argv[1]);
+        return 1;
+    }
+    State_t state = read_state(argv[2]);
+    check(state);
+    change(state, number_of_operations);
+    check(state);
+    write_state(argv[2], state);
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%zu failures\n", failures);
+        return 1;
+    }
+    return 0;
+}
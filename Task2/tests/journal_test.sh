@@ -0,0 +1,28 @@
+#!/bin/sh
+# Runs journal test many times on the same journal and checks that the file doesn't grow with history
+# of operations, only with queues kept in it.
+# Usage: tests/journal_test.sh [number_of_runs=8]
+set -eu
+
+runs=${1:-8}
+
+cd "$(dirname "$0")/.."
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+CXX=${CXX:-g++}
+FLAGS="-std=c++20 -O2 -Wall -Wextra -DNDEBUG"
+$CXX $FLAGS tests/journal_test.cpp strqueue.cpp -o "$work/test"
+
+first_size=
+for run in $(seq 1 "$runs"); do
+    "$work/test" "$work/journal" "$work/state" "$run"
+    size=$(wc -c < "$work/journal")
+    echo "run $run: journal of $size bytes"
+    first_size=${first_size:-$size}
+    if [ "$size" -gt $((2 * first_size)) ]; then
+        echo "FAILED: journal grows with history of operations" >&2
+        exit 1
+    fi
+done
+echo "journal test passed"
@@ -0,0 +1,171 @@
+// Stress test of strqueue built with STRQUEUE_THREAD_SAFE, meant to be run also under ThreadSanitizer.
+// Threads compare and clone the same queues with ids given in both orders, so locks of two slots are taken
+// in every order, and change clones while other threads read queues which share strings with them.
+// Usage: thread_safety_test [number_of_threads [iterations]]
+
+#include "../strqueue.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using namespace cxx;
+
+    std::atomic<std::size_t> failures{0};
+
+    void check(bool condition, const char *message) {
+        if (!condition && failures.fetch_add(1) < 10)
+            std::fprintf(stderr, "FAILED: %s\n", message);
+    }
+
+    // Generator of pseudo random numbers private to one thread.
+    class Random_t {
+    public:
+        explicit Random_t(std::uint64_t seed) : state(seed * 2 + 1) {}
+
+        std::size_t below(std::size_t bound) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state % bound;
+        }
+
+    private:
+        std::uint64_t state;
+    };
+
+    template <typename Function>
+    void run_threads(std::size_t number_of_threads, const Function &function) {
+        std::vector<std::thread> threads;
+        for (std::size_t thread = 0; thread < number_of_threads; thread++)
+            threads.emplace_back(function, thread);
+        for (auto &thread : threads)
+            thread.join();
+    }
+
+    // Queues which never change are compared in both orders and cloned while other queues, including clones,
+    // are changed, compared with them and deleted. Deadlock in taking locks of two slots hangs the test.
+    void test_lock_ordering(std::size_t number_of_threads, std::size_t iterations) {
+        constexpr std::size_t FIXED_COUNT = 6;
+        constexpr std::size_t CHANGED_COUNT = 4;
+        std::vector<unsigned long> fixed, changed;
+        for (std::size_t i = 0; i < FIXED_COUNT; i++) {
+            fixed.push_back(strqueue_new());
+            // Queue i holds strings "a", "b", ... up to i-th letter, so it's smaller than queues after it.
+            for (std::size_t j = 0; j <= i; j++)
+                strqueue_insert_at(fixed[i], j, std::string(1, static_cast<char>('a' + j)).c_str());
+        }
+        for (std::size_t i = 0; i < CHANGED_COUNT; i++)
+            changed.push_back(strqueue_new());
+
+        run_threads(number_of_threads, [&](std::size_t thread) {
+            Random_t random(thread);
+            for (std::size_t iteration = 0; iteration < iterations; iteration++) {
+                const std::size_t first = random.below(FIXED_COUNT), second = random.below(FIXED_COUNT);
+                const int expected = first < second ? -1 : first > second ? 1 : 0;
+                check(strqueue_comp(fixed[first], fixed[second]) == expected, "comparison of fixed queues");
+                check(strqueue_comp(fixed[second], fixed[first]) == -expected, "reversed comparison");
+
+                const unsigned long clone = strqueue_clone(fixed[first]);
+                check(strqueue_comp(clone, fixed[first]) == 0, "clone is equal to its source");
+                strqueue_insert_at(clone, random.below(first + 2), "z");
+                check(strqueue_size(clone) == first + 2, "size of changed clone");
+                check(strqueue_size(fixed[first]) == first + 1, "source doesn't see change of clone");
+                check(strqueue_comp(fixed[first], clone) == -1, "changed clone is greater than source");
+
+                const unsigned long target = changed[random.below(CHANGED_COUNT)];
+                strqueue_insert_at(target, random.below(4), "x");
+                if (strqueue_size(target) > 8)
+                    strqueue_remove_range(target, 0, 4);
+                const int order = strqueue_comp(target, fixed[second]);
+                check(order >= -1 && order <= 1, "comparison result is -1, 0 or 1");
+                // Queue changed by other threads is compared in both orders only to take both locks.
+                strqueue_comp(clone, target);
+                strqueue_comp(target, clone);
+
+                strqueue_delete(clone);
+                check(strqueue_size(clone) == 0, "deleted queue is empty");
+                check(strqueue_get_at(clone, 0) == nullptr, "deleted queue has no strings");
+            }
+        });
+
+        for (unsigned long id : fixed)
+            strqueue_delete(id);
+        for (unsigned long id : changed)
+            strqueue_delete(id);
+    }
+
+    // One thread keeps replacing strings of a queue while others clone it, change clones of clones
+    // and check that clones hold the strings the queue had when it was cloned.
+    void test_shared_strings(std::size_t number_of_threads, std::size_t iterations) {
+        constexpr std::size_t SIZE = 3000;
+        auto string_at = [](std::size_t position) {
+            return "s" + std::to_string(position);
+        };
+
+        const unsigned long source = strqueue_new();
+        for (std::size_t position = 0; position < SIZE; position++)
+            strqueue_insert_at(source, position, string_at(position).c_str());
+
+        std::atomic<bool> is_writing{true};
+        std::thread writer([&]() {
+            for (std::size_t iteration = 0; iteration < iterations * 10; iteration++) {
+                const std::size_t position = iteration * 7919 % SIZE;
+                strqueue_remove_at(source, position);
+                strqueue_insert_at(source, position, string_at(position).c_str());
+            }
+            is_writing = false;
+        });
+
+        run_threads(number_of_threads, [&](std::size_t thread) {
+            Random_t random(thread);
+            do {
+                const unsigned long clone = strqueue_clone(source);
+                const unsigned long clone_of_clone = strqueue_clone(clone);
+                for (std::size_t k = 0; k < 50; k++) {
+                    const std::size_t position = random.below(SIZE - 1);
+                    strqueue_remove_at(clone_of_clone, position);
+                    strqueue_insert_at(clone_of_clone, position, "changed");
+                }
+
+                // Clone made between removal and insertion misses one string, then it isn't checked.
+                const std::size_t size = strqueue_size(clone);
+                check(size == SIZE || size == SIZE - 1, "size of clone");
+                if (size == SIZE) {
+                    std::vector<const char *> strs(SIZE);
+                    check(strqueue_get_range(clone, 0, SIZE, strs.data()) == SIZE, "range of clone");
+                    for (std::size_t position = 0; position < SIZE; position++)
+                        check(std::strcmp(strs[position], string_at(position).c_str()) == 0,
+                              "clone keeps strings of source");
+                }
+
+                strqueue_delete(clone);
+                check(strqueue_comp(clone_of_clone, clone_of_clone) == 0, "queue is equal to itself");
+                strqueue_delete(clone_of_clone);
+            } while (is_writing);
+        });
+
+        writer.join();
+        strqueue_delete(source);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const std::size_t number_of_threads = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 8;
+    const std::size_t iterations = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20000;
+
+    test_lock_ordering(number_of_threads, iterations);
+    test_shared_strings(number_of_threads, iterations);
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%zu checks failed\n", failures.load());
+        return 1;
+    }
+    std::printf("OK\n");
+    return 0;
+}
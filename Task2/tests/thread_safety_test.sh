@@ -0,0 +1,22 @@
+#!/bin/sh
+# Runs stress test of thread safe strqueue built normally, under ThreadSanitizer, and with debug trace,
+# whose output is discarded.
+# Usage: tests/thread_safety_test.sh [number_of_threads [iterations]]
+set -eu
+
+cd "$(dirname "$0")/.."
+number_of_threads=${1:-8}
+iterations=${2:-5000}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+CXX=${CXX:-g++}
+FLAGS="-std=c++20 -Wall -Wextra -pthread -DSTRQUEUE_THREAD_SAFE"
+$CXX $FLAGS -O2 -DNDEBUG tests/thread_safety_test.cpp strqueue.cpp -o "$work/test"
+$CXX $FLAGS -O1 -g -DNDEBUG -fsanitize=thread tests/thread_safety_test.cpp strqueue.cpp -o "$work/test_tsan"
+$CXX $FLAGS -O1 -g -DSTRQUEUE_CONTENT_HASH -fsanitize=thread tests/thread_safety_test.cpp strqueue.cpp \
+    -o "$work/test_tsan_debug"
+
+"$work/test" "$number_of_threads" "$iterations"
+TSAN_OPTIONS="halt_on_error=1" "$work/test_tsan" "$number_of_threads" "$iterations"
+TSAN_OPTIONS="halt_on_error=1" "$work/test_tsan_debug" "$number_of_threads" $((iterations / 10)) 2> /dev/null
@@ -0,0 +1,17 @@
+// Program which calls strqueue functions, writes its own line to standard error and fails an assertion,
+// used by trace_test.sh to check that debug trace isn't lost when program is aborted.
+
+#include "../strqueue.h"
+
+#include <cassert>
+#include <cstdio>
+
+int main() {
+    using namespace cxx;
+
+    const unsigned long id = strqueue_new();
+    strqueue_insert_at(id, 0, "traced");
+    std::fprintf(stderr, "client line\n");
+    assert(strqueue_size(id) == 0);
+    return 0;
+}
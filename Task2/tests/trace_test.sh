@@ -0,0 +1,41 @@
+#!/bin/sh
+# Checks that debug trace of strqueue is printed when program fails an assertion, after the program's own
+# output with buffered trace and in order with it with STRQUEUE_SYNC_TRACE.
+# Usage: tests/trace_test.sh
+set -eu
+
+cd "$(dirname "$0")/.."
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+CXX=${CXX:-g++}
+$CXX -std=c++20 -O2 -Wall -Wextra tests/trace_abort.cpp strqueue.cpp -o "$work/buffered"
+$CXX -std=c++20 -O2 -Wall -Wextra -DSTRQUEUE_SYNC_TRACE tests/trace_abort.cpp strqueue.cpp -o "$work/sync"
+
+cat > "$work/trace" <<'END'
+strqueue_new()
+strqueue_new returns 0
+strqueue_insert_at(0, 0, "traced")
+strqueue_insert_at done
+strqueue_size(0)
+strqueue_size returns 1
+END
+
+for mode in buffered sync; do
+    if "$work/$mode" 2> "$work/$mode.err"; then
+        echo "$mode: assertion didn't fail"
+        exit 1
+    fi
+    grep -v -e "client line" -e "Assertion" -e "Aborted" "$work/$mode.err" > "$work/$mode.trace" || true
+    if ! cmp -s "$work/trace" "$work/$mode.trace"; then
+        echo "$mode: trace differs"
+        cat "$work/$mode.err"
+        exit 1
+    fi
+done
+
+if [ "$(sed -n 5p "$work/sync.err")" != "client line" ]; then
+    echo "sync: trace isn't printed in order with other output"
+    exit 1
+fi
+echo "OK"
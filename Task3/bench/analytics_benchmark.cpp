@@ -0,0 +1,116 @@
+// Benchmark of roster analytics against the naive loops they replace: the
+// loop of the first max_diff_classes, a saturating sum, a histogram filled
+// knight by knight and dominance counts comparing all pairs. Every result is
+// checked against the naive one.
+// Usage: analytics_benchmark [seed [number_of_knights [dominance_knights [threads]]]]
+
+#include "knights.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+    constexpr size_t BINS = 1000;
+
+    bool all_same = true;
+
+    template <typename Function>
+    auto timed(Function function) {
+        const auto start = std::chrono::steady_clock::now();
+        auto result = function();
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        return std::make_pair(elapsed.count(), std::move(result));
+    }
+
+    template <typename Result>
+    void report(const char *name, const std::pair<double, Result> &naive, const std::pair<double, Result> &fast,
+                const std::pair<double, Result> &parallel) {
+        const bool same = fast.second == naive.second && parallel.second == naive.second;
+        all_same = all_same && same;
+        std::cout << name << ": naive " << naive.first << " ms, constexpr " << fast.first << " ms, parallel "
+                  << parallel.first << " ms" << (same ? "" : ", DIFFERENT RESULTS") << "\n";
+    }
+
+    std::pair<size_t, size_t> naive_max_diff_classes(const std::vector<Knight> &knights) {
+        std::pair<size_t, size_t> max_diff(0, 0);
+        for (const Knight &knight : knights) {
+            const size_t diff = knight.get_armour_class() > knight.get_weapon_class()
+                                    ? knight.get_armour_class() - knight.get_weapon_class()
+                                    : knight.get_weapon_class() - knight.get_armour_class();
+            const size_t max = max_diff.second > max_diff.first ? max_diff.second - max_diff.first
+                                                                : max_diff.first - max_diff.second;
+            if (diff >= max)
+                max_diff = std::make_pair(knight.get_weapon_class(), knight.get_armour_class());
+        }
+        return max_diff;
+    }
+
+    size_t naive_total_gold(const std::vector<Knight> &knights) {
+        size_t total = 0;
+        for (const Knight &knight : knights)
+            total = Knight::MAX_GOLD - total > knight.get_gold() ? total + knight.get_gold() : Knight::MAX_GOLD;
+        return total;
+    }
+
+    std::vector<size_t> naive_class_histogram(const std::vector<Knight> &knights) {
+        std::vector<size_t> histogram(2 * BINS);
+        for (const Knight &knight : knights) {
+            histogram[knight.get_weapon_class() < BINS ? knight.get_weapon_class() : BINS - 1]++;
+            histogram[BINS + (knight.get_armour_class() < BINS ? knight.get_armour_class() : BINS - 1)]++;
+        }
+        return histogram;
+    }
+
+    std::vector<size_t> flattened(const ClassHistogram &histogram) {
+        std::vector<size_t> flat = histogram.weapon;
+        flat.insert(flat.end(), histogram.armour.begin(), histogram.armour.end());
+        return flat;
+    }
+
+    std::vector<size_t> naive_dominance_counts(const std::vector<Knight> &knights) {
+        std::vector<size_t> counts(knights.size());
+        for (size_t i = 0; i < knights.size(); i++)
+            for (const Knight &other : knights)
+                counts[i] += knights[i] > other;
+        return counts;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const unsigned long long seed = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1;
+    const size_t number_of_knights = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10000000;
+    const size_t dominance_knights =
+        std::min<size_t>(number_of_knights, argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 20000);
+    const size_t threads = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : std::thread::hardware_concurrency();
+
+    std::mt19937_64 generator(seed);
+    std::vector<Knight> knights;
+    knights.reserve(number_of_knights);
+    for (size_t i = 0; i < number_of_knights; i++)
+        knights.emplace_back(generator() % 1000000000000, generator() % BINS, generator() % BINS);
+    const std::vector<Knight> dominance_roster(knights.begin(),
+                                               knights.begin() + static_cast<std::ptrdiff_t>(dominance_knights));
+
+    std::cout << number_of_knights << " knights, " << threads << " threads\n";
+    report("max_diff_classes", timed([&] { return naive_max_diff_classes(knights); }),
+           timed([&] { return max_diff_classes(knights.begin(), knights.end()); }),
+           timed([&] { return parallel_max_diff_classes(knights, threads); }));
+    report("total_gold", timed([&] { return naive_total_gold(knights); }),
+           timed([&] { return total_gold(knights.begin(), knights.end()); }),
+           timed([&] { return parallel_total_gold(knights, threads); }));
+    report("class_histogram", timed([&] { return naive_class_histogram(knights); }),
+           timed([&] { return flattened(class_histogram(knights.begin(), knights.end(), BINS)); }),
+           timed([&] { return flattened(parallel_class_histogram(knights, BINS, threads)); }));
+
+    // Dominance counts have no parallel version, so the sweep is timed twice.
+    std::cout << dominance_knights << " knights for dominance counts\n";
+    report("dominance_counts", timed([&] { return naive_dominance_counts(dominance_roster); }),
+           timed([&] { return dominance_counts(dominance_roster.begin(), dominance_roster.end()); }),
+           timed([&] { return dominance_counts(dominance_roster.begin(), dominance_roster.end()); }));
+    return all_same ? 0 : 1;
+}
@@ -0,0 +1,16 @@
+#!/bin/sh
+# Compares roster analytics with the naive loops they replace, on one thread
+# and in parallel. Every result is checked against the naive one, so the
+# script fails if any of them differs.
+# Usage: bench/analytics_benchmark.sh [seed [number_of_knights [dominance_knights [threads]]]]
+set -eu
+
+cd "$(dirname "$0")/.."
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++20 -O2 -pthread}
+$CXX $CXXFLAGS -I. bench/analytics_benchmark.cpp -o "$work/analytics_benchmark"
+
+"$work/analytics_benchmark" "$@"
@@ -0,0 +1,47 @@
+// Benchmark of a tournament whose contestants keep changing: knights are
+// added with operator+= and removed with operator-= one at a time, then the
+// tournament is played once. Uses only the interface of the first version of
+// Tournament, so it can be built with any of them, see churn_benchmark.sh.
+// Usage: churn_benchmark [number_of_knights [number_of_changes]]
+
+#include "knights.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main(int argc, char *argv[]) {
+    const size_t number_of_knights = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    const size_t number_of_changes = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200000;
+    if (number_of_knights == 0) {
+        std::cerr << "There has to be at least one knight.\n";
+        return 1;
+    }
+
+    std::mt19937_64 generator(3);
+    auto random_knight = [&generator] {
+        return Knight(generator() % 100000, generator() % 100, generator() % 100);
+    };
+    std::vector<Knight> knights;
+    knights.reserve(number_of_knights);
+    for (size_t i = 0; i < number_of_knights; i++)
+        knights.push_back(random_knight());
+
+    // Every change adds a new knight and removes one of the first knights,
+    // who is usually still in the tournament.
+    const auto start = std::chrono::steady_clock::now();
+    Tournament tournament(knights);
+    for (size_t i = 0; i < number_of_changes; i++) {
+        tournament += random_knight();
+        tournament -= knights[generator() % knights.size()];
+    }
+    const auto winner = tournament.play();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << number_of_knights << " knights, " << number_of_changes << " additions and removals: "
+              << elapsed.count() << " s, " << tournament.size() << " knights played, "
+              << (winner == tournament.no_winner() ? "no winner" : "a winner") << "\n";
+    return 0;
+}
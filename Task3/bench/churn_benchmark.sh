@@ -0,0 +1,24 @@
+#!/bin/sh
+# Compares adding and removing knights one at a time with the first version
+# of Tournament, taken from the root commit, which searched the whole list
+# on every removal. With the default sizes the first version takes minutes.
+# Usage: bench/churn_benchmark.sh [number_of_knights [number_of_changes]]
+set -eu
+
+cd "$(dirname "$0")/.."
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+baseline=$(git rev-list --max-parents=0 HEAD)
+mkdir "$work/baseline"
+git show "$baseline:Task3/knights.h" > "$work/baseline/knights.h"
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++20 -O2}
+$CXX $CXXFLAGS -I"$work/baseline" bench/churn_benchmark.cpp -o "$work/churn_baseline"
+$CXX $CXXFLAGS -I. bench/churn_benchmark.cpp -o "$work/churn_benchmark"
+
+echo "First version:"
+"$work/churn_baseline" "$@"
+echo "Current version:"
+"$work/churn_benchmark" "$@"
@@ -0,0 +1,46 @@
+// Benchmark of Tournament::play() on large random rosters. Uses only the
+// interface of the first version of Tournament, so it can be built with any
+// of them, see play_benchmark.sh.
+// Usage: play_benchmark [number_of_knights [number_of_tournaments]]
+
+#include "knights.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main(int argc, char *argv[]) {
+    const size_t number_of_knights = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const size_t number_of_tournaments = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5;
+    if (number_of_knights == 0 || number_of_tournaments == 0) {
+        std::cerr << "There has to be at least one knight and one tournament.\n";
+        return 1;
+    }
+
+    std::mt19937_64 generator(5);
+    std::vector<Knight> knights(number_of_knights, TRAINEE_KNIGHT);
+    double construction = 0, playing = 0;
+    size_t winners = 0;
+    for (size_t t = 0; t < number_of_tournaments; t++) {
+        for (Knight &knight : knights)
+            knight = Knight(generator() % 100000, generator() % 1000, generator() % 1000);
+
+        // Construction, which copies the roster, is timed apart from play().
+        const auto start = std::chrono::steady_clock::now();
+        Tournament tournament(knights);
+        const auto constructed = std::chrono::steady_clock::now();
+        const auto winner = tournament.play();
+        const auto played = std::chrono::steady_clock::now();
+        winners += winner != tournament.no_winner();
+
+        construction += std::chrono::duration<double>(constructed - start).count();
+        playing += std::chrono::duration<double>(played - constructed).count();
+    }
+
+    std::cout << number_of_tournaments << " tournaments of " << number_of_knights << " knights: construction "
+              << construction / number_of_tournaments << " s, play() " << playing / number_of_tournaments
+              << " s on average, " << winners << " with a winner\n";
+    return 0;
+}
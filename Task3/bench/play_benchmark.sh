@@ -0,0 +1,23 @@
+#!/bin/sh
+# Compares Tournament::play() on a million knights with the first version of
+# Tournament, taken from the root commit, which kept contestants in std::list.
+# Usage: bench/play_benchmark.sh [number_of_knights [number_of_tournaments]]
+set -eu
+
+cd "$(dirname "$0")/.."
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+baseline=$(git rev-list --max-parents=0 HEAD)
+mkdir "$work/baseline"
+git show "$baseline:Task3/knights.h" > "$work/baseline/knights.h"
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++20 -O2}
+$CXX $CXXFLAGS -I"$work/baseline" bench/play_benchmark.cpp -o "$work/play_baseline"
+$CXX $CXXFLAGS -I. bench/play_benchmark.cpp -o "$work/play_benchmark"
+
+echo "First version:"
+"$work/play_baseline" "$@"
+echo "Current version:"
+"$work/play_benchmark" "$@"
@@ -2,12 +2,24 @@
 #define KNIGHTS_H_
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <compare>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <istream>
 #include <limits>
-#include <list>
+#include <mutex>
+#include <numeric>
 #include <ostream>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 class Knight {
 public:
@@ -33,34 +45,34 @@ public:
         return weapon_class_;
     }
 
-    void take_gold(const size_t gold) {
+    constexpr void take_gold(const size_t gold) {
         if (MAX_GOLD - gold_ > gold)
             gold_ += gold;
         else
             gold_ = MAX_GOLD;
     }
 
-    size_t give_gold() {
+    constexpr size_t give_gold() {
         size_t g = gold_;
         gold_ = 0;
         return g;
     }
 
-    void change_weapon(const size_t weapon_class) {
+    constexpr void change_weapon(const size_t weapon_class) {
         weapon_class_ = weapon_class;
     }
 
-    size_t give_up_weapon() {
+    constexpr size_t give_up_weapon() {
         const size_t wc = weapon_class_;
         weapon_class_ = 0;
         return wc;
     }
 
-    void change_armour(const size_t armor_class) {
+    constexpr void change_armour(const size_t armor_class) {
         armor_class_ = armor_class;
     }
 
-    size_t take_off_armour() {
+    constexpr size_t take_off_armour() {
         const size_t ac = armor_class_;
         armor_class_ = 0;
         return ac;
@@ -91,6 +103,15 @@ public:
         return std::weak_ordering::equivalent;
     }
 
+    // Tells whether a knight with the first pair of classes defeats one with
+    // the second, like operator<=> but without branches.
+    constexpr static bool defeats(const size_t weapon_class, const size_t armor_class,
+                                  const size_t other_weapon_class, const size_t other_armor_class) {
+        return (weapon_class > other_armor_class)
+               & ((armor_class >= other_weapon_class) | (armor_class > other_armor_class)
+                  | ((armor_class == other_armor_class) & (weapon_class > other_weapon_class)));
+    }
+
     constexpr bool operator==(const Knight &other) const {
         if (*this <=> other == nullptr)
             return true;
@@ -109,7 +130,7 @@ public:
         return result;
     }
 
-    Knight& operator+=(Knight &other) & {
+    constexpr Knight& operator+=(Knight &other) & {
         take_gold(other.give_gold());
         if (other.weapon_class_ > weapon_class_) {
             weapon_class_ = other.weapon_class_;
@@ -136,82 +157,550 @@ inline std::ostream &operator<<(std::ostream &os, const Knight &knight) {
 
 static constexpr auto TRAINEE_KNIGHT = Knight(0, 1, 1);
 
-class Tournament {
+// Plays one round of Tournament::play() on the first count contestants:
+// every pair of consecutive contestants duels, the winners move to the
+// front in order and the odd contestant out, if any, moves to position 0 to
+// fight first in the next round. The contestants are known only through
+// the hooks of round, called for the pair at positions first and first + 1:
+//   outcome(first) is 1 if the former wins, -1 if the latter does and 0 for
+//     a draw;
+//   fight(first, outcome) hands the loser's gold and equipment to the winner;
+//   eliminate(position) is called for the loser, or for both knights of
+//     a draw, the latter first;
+//   move(from, to) moves the winner to its place among the survivors.
+// Survivors never overwrite a pair that has yet to fight or the odd
+// contestant. Returns the number of survivors.
+template <typename Round>
+constexpr size_t play_tournament_round(Round &round, const size_t count) {
+    size_t survivors = count % 2;
+    for (size_t first = 0; first + 1 < count; first += 2) {
+        const int outcome = round.outcome(first);
+        round.fight(first, outcome);
+        if (outcome == 0) {
+            round.eliminate(first + 1);
+            round.eliminate(first);
+            continue;
+        }
+
+        const size_t winner = outcome > 0 ? first : first + 1;
+        round.eliminate(winner ^ 1);
+        round.move(winner, survivors++);
+    }
+
+    if (count % 2 != 0)
+        round.move(count - 1, 0);
+    return survivors;
+}
+
+// Hooks of play_tournament_round() for knights in an indexable container,
+// fighting as operator<=> and operator+= say. Rounds that also log duels or
+// track the knights derive from it and extend the hooks.
+template <typename Knights>
+struct KnightRound {
+    Knights &knights;
+
+    constexpr int outcome(const size_t first) const {
+        const Knight &knight1 = knights[first];
+        const Knight &knight2 = knights[first + 1];
+        return static_cast<int>(Knight::defeats(knight1.get_weapon_class(), knight1.get_armour_class(),
+                                                knight2.get_weapon_class(), knight2.get_armour_class()))
+               - static_cast<int>(Knight::defeats(knight2.get_weapon_class(), knight2.get_armour_class(),
+                                                  knight1.get_weapon_class(), knight1.get_armour_class()));
+    }
+
+    constexpr void fight(const size_t first, const int outcome) {
+        if (outcome != 0)
+            knights[outcome > 0 ? first : first + 1] += knights[outcome > 0 ? first + 1 : first];
+    }
+
+    constexpr void eliminate(size_t) {}
+
+    constexpr void move(const size_t from, const size_t to) {
+        knights[to] = knights[from];
+    }
+};
+
+// Knights stored as separate gold, weapon and armour arrays, so that many
+// independent duels can be resolved in a single data-parallel sweep.
+class KnightBatch {
+public:
+    KnightBatch() = default;
+
+    template <typename Container>
+    explicit KnightBatch(const Container &knights) {
+        for (const Knight &knight : knights)
+            push_back(knight);
+    }
+
+    KnightBatch(std::initializer_list<Knight> knights) {
+        reserve(knights.size());
+        for (const Knight &knight : knights)
+            push_back(knight);
+    }
+
+    size_t size() const {
+        return gold_.size();
+    }
+
+    bool empty() const {
+        return gold_.empty();
+    }
+
+    void reserve(const size_t count) {
+        gold_.reserve(count);
+        weapon_class_.reserve(count);
+        armor_class_.reserve(count);
+    }
+
+    void clear() {
+        gold_.clear();
+        weapon_class_.clear();
+        armor_class_.clear();
+    }
+
+    void push_back(const Knight &knight) {
+        gold_.push_back(knight.get_gold());
+        weapon_class_.push_back(knight.get_weapon_class());
+        armor_class_.push_back(knight.get_armour_class());
+    }
+
+    Knight operator[](const size_t i) const {
+        return Knight(gold_[i], weapon_class_[i], armor_class_[i]);
+    }
+
+    // Resolves count independent duels between knights first + 2i and
+    // first + 2i + 1 exactly as operator<=> and operator+= would, and stores
+    // in outcomes[i] 1 if the former won, -1 if the latter won and 0 for
+    // a draw. The loop has no branches, so the compiler can vectorise it.
+    void duel_pairs(const size_t first, const size_t count, signed char *outcomes) {
+        size_t *gold = gold_.data() + first;
+        size_t *weapon = weapon_class_.data() + first;
+        size_t *armor = armor_class_.data() + first;
+
+        for (size_t i = 0; i < count; i++) {
+            const size_t g1 = gold[2 * i], w1 = weapon[2 * i], a1 = armor[2 * i];
+            const size_t g2 = gold[2 * i + 1], w2 = weapon[2 * i + 1], a2 = armor[2 * i + 1];
+
+            const bool first_wins = Knight::defeats(w1, a1, w2, a2);
+            const bool second_wins = Knight::defeats(w2, a2, w1, a1);
+            outcomes[i] = static_cast<signed char>(first_wins - second_wins);
+
+            // All ones when the first knight won, or when the duel was drawn
+            // and nothing changes hands anyway.
+            const size_t first_mask = -static_cast<size_t>(!second_wins);
+            const size_t fight_mask = -static_cast<size_t>(first_wins | second_wins);
+
+            const size_t winner_gold = (g1 & first_mask) | (g2 & ~first_mask);
+            const size_t loser_gold = (g2 & first_mask) | (g1 & ~first_mask);
+            const size_t winner_weapon = (w1 & first_mask) | (w2 & ~first_mask);
+            const size_t loser_weapon = (w2 & first_mask) | (w1 & ~first_mask);
+            const size_t winner_armor = (a1 & first_mask) | (a2 & ~first_mask);
+            const size_t loser_armor = (a2 & first_mask) | (a1 & ~first_mask);
+
+            size_t sum = winner_gold + (loser_gold & fight_mask);
+            sum |= -static_cast<size_t>(sum < winner_gold);
+            const size_t new_loser_gold = loser_gold & ~fight_mask;
+            const size_t weapon_mask = -static_cast<size_t>(loser_weapon > winner_weapon) & fight_mask;
+            const size_t armor_mask = -static_cast<size_t>(loser_armor > winner_armor) & fight_mask;
+
+            const size_t new_winner_weapon = (loser_weapon & weapon_mask) | (winner_weapon & ~weapon_mask);
+            const size_t new_loser_weapon = loser_weapon & ~weapon_mask;
+            const size_t new_winner_armor = (loser_armor & armor_mask) | (winner_armor & ~armor_mask);
+            const size_t new_loser_armor = loser_armor & ~armor_mask;
+
+            gold[2 * i] = (sum & first_mask) | (new_loser_gold & ~first_mask);
+            gold[2 * i + 1] = (new_loser_gold & first_mask) | (sum & ~first_mask);
+            weapon[2 * i] = (new_winner_weapon & first_mask) | (new_loser_weapon & ~first_mask);
+            weapon[2 * i + 1] = (new_loser_weapon & first_mask) | (new_winner_weapon & ~first_mask);
+            armor[2 * i] = (new_winner_armor & first_mask) | (new_loser_armor & ~first_mask);
+            armor[2 * i + 1] = (new_loser_armor & first_mask) | (new_winner_armor & ~first_mask);
+        }
+    }
+
+    // Plays one tournament round: every pair of consecutive knights duels
+    // and the batch is left in the order Tournament::play() would reach
+    // after those fights, i.e. the odd knight out (if any) followed by the
+    // winners. Eliminated knights are appended to eliminated in the order
+    // of elimination.
+    void play_round(KnightBatch &eliminated) {
+        const size_t pairs = size() / 2;
+        outcomes_.resize(pairs);
+        duel_pairs(0, pairs, outcomes_.data());
+
+        Round round{*this, eliminated};
+        const size_t survivors = play_tournament_round(round, size());
+        gold_.resize(survivors);
+        weapon_class_.resize(survivors);
+        armor_class_.resize(survivors);
+    }
+
+private:
+    void push_back(const size_t gold, const size_t weapon_class, const size_t armor_class) {
+        gold_.push_back(gold);
+        weapon_class_.push_back(weapon_class);
+        armor_class_.push_back(armor_class);
+    }
+
+    // Hooks of a round whose duels duel_pairs() has already fought.
+    struct Round {
+        KnightBatch &batch;
+        KnightBatch &eliminated;
+
+        int outcome(const size_t first) const {
+            return batch.outcomes_[first / 2];
+        }
+
+        void fight(size_t, int) {}
+
+        void eliminate(const size_t position) {
+            eliminated.push_back(batch.gold_[position], batch.weapon_class_[position], batch.armor_class_[position]);
+        }
+
+        void move(const size_t from, const size_t to) {
+            batch.gold_[to] = batch.gold_[from];
+            batch.weapon_class_[to] = batch.weapon_class_[from];
+            batch.armor_class_[to] = batch.armor_class_[from];
+        }
+    };
+
+    std::vector<size_t> gold_, weapon_class_, armor_class_;
+    std::vector<signed char> outcomes_;
+};
+
+// One duel of a played tournament: the round (counted from zero), the
+// position of the first knight within that round, the outcome (1 if the
+// first knight won, -1 if the second did, 0 for a draw) and what the winner
+// took: the loser's gold and the classes of the equipment it took over, or
+// zero for the pieces it kept.
+struct DuelRecord {
+    size_t first;
+    size_t gold;
+    size_t weapon_class;
+    size_t armor_class;
+    uint32_t round;
+    int8_t outcome;
+};
+
+// Log policy of BasicTournament that records nothing and costs nothing.
+struct NoEventLog {
+    static constexpr bool enabled = false;
+};
+
+// Log policy of BasicTournament that keeps a DuelRecord for every duel of
+// the last play(), in a buffer reserved up front for the largest possible
+// number of duels.
+class EventLog {
+public:
+    static constexpr bool enabled = true;
+
+    struct Summary {
+        size_t duels = 0;
+        size_t draws = 0;
+        size_t rounds = 0;
+        size_t gold = 0;
+        size_t weapons = 0;
+        size_t armours = 0;
+    };
+
+    struct State {
+        std::vector<Knight> contestants;
+        std::vector<Knight> eliminated;
+    };
+
+    const std::vector<DuelRecord> &records() const {
+        return records_;
+    }
+
+    void clear() {
+        records_.clear();
+    }
+
+    void reserve(const size_t count) {
+        records_.reserve(count);
+    }
+
+    void record(const DuelRecord &record) {
+        records_.push_back(record);
+    }
+
+    // Counts duels, draws, rounds and the gold (saturated) and pieces of
+    // equipment that changed hands.
+    Summary summary() const {
+        Summary summary;
+        for (const DuelRecord &record : records_) {
+            summary.duels++;
+            summary.draws += record.outcome == 0;
+            summary.rounds = std::max<size_t>(summary.rounds, record.round + size_t{1});
+            summary.gold = std::min(Knight::MAX_GOLD - record.gold, summary.gold) + record.gold;
+            summary.weapons += record.weapon_class != 0;
+            summary.armours += record.armor_class != 0;
+        }
+        return summary;
+    }
+
+    // Replays the log on the contestants the tournament started with,
+    // applying the recorded outcomes and transfers without comparing the
+    // knights, and returns the contestants and eliminated knights (in the
+    // order operator<< prints them) it ends with. Throws
+    // std::invalid_argument if the log does not fit the contestants.
+    State replay(std::vector<Knight> contestants) const {
+        State state;
+        Replay replay{{contestants}, records_, state};
+        for (; contestants.size() > 1; replay.round++) {
+            const size_t survivors = play_tournament_round(replay, contestants.size());
+            contestants.erase(contestants.begin() + static_cast<std::ptrdiff_t>(survivors), contestants.end());
+        }
+
+        if (replay.next != records_.size())
+            throw std::invalid_argument("Event log does not match the tournament.");
+        std::reverse(state.eliminated.begin(), state.eliminated.end());
+        state.contestants = std::move(contestants);
+        return state;
+    }
+
+    // The binary form is a header of MAGIC, FORMAT_VERSION, BYTE_ORDER_MARK
+    // and the record count, followed by the records field by field with no
+    // padding. Numbers are written in the writer's byte order, which the
+    // mark tells the reader.
+    void write(std::ostream &os) const {
+        char header[HEADER_SIZE];
+        char *end = std::copy(std::begin(MAGIC), std::end(MAGIC), header);
+        end = put(end, FORMAT_VERSION);
+        end = put(end, BYTE_ORDER_MARK);
+        put(end, uint64_t{records_.size()});
+        os.write(header, HEADER_SIZE);
+
+        char record[RECORD_SIZE];
+        for (const DuelRecord &duel : records_) {
+            end = put(record, uint64_t{duel.first});
+            end = put(end, uint64_t{duel.gold});
+            end = put(end, uint64_t{duel.weapon_class});
+            end = put(end, uint64_t{duel.armor_class});
+            end = put(end, duel.round);
+            put(end, duel.outcome);
+            os.write(record, RECORD_SIZE);
+        }
+    }
+
+    // Reads a log written by write() in either byte order. Returns false,
+    // keeping the records, if the header does not match or the records are
+    // cut short or could not have been logged by play(): an outcome other
+    // than -1, 0 or 1, a draw with transfers, or duels out of order.
+    bool read(std::istream &is) {
+        char header[HEADER_SIZE];
+        if (!is.read(header, HEADER_SIZE) || !std::equal(std::begin(MAGIC), std::end(MAGIC), header))
+            return false;
+
+        uint32_t version, byte_order, swapped_byte_order;
+        uint64_t count;
+        const char *const byte_order_field = header + sizeof(MAGIC) + sizeof(version);
+        get(byte_order_field, byte_order, false);
+        get(byte_order_field, swapped_byte_order, true);
+        if (byte_order != BYTE_ORDER_MARK && swapped_byte_order != BYTE_ORDER_MARK)
+            return false;
+
+        const bool swapped = byte_order != BYTE_ORDER_MARK;
+        get(header + sizeof(MAGIC), version, swapped);
+        get(byte_order_field + sizeof(byte_order), count, swapped);
+        if (version != FORMAT_VERSION)
+            return false;
+
+        std::vector<DuelRecord> records;
+        char record[RECORD_SIZE];
+        while (records.size() < count) {
+            if (!is.read(record, RECORD_SIZE))
+                return false;
+
+            uint64_t first, gold, weapon_class, armor_class;
+            uint32_t round;
+            int8_t outcome;
+            const char *next = get(record, first, swapped);
+            next = get(next, gold, swapped);
+            next = get(next, weapon_class, swapped);
+            next = get(next, armor_class, swapped);
+            next = get(next, round, swapped);
+            get(next, outcome, swapped);
+            if (std::max({first, gold, weapon_class, armor_class}) > std::numeric_limits<size_t>::max())
+                return false;
+
+            const DuelRecord duel{static_cast<size_t>(first), static_cast<size_t>(gold),
+                                  static_cast<size_t>(weapon_class), static_cast<size_t>(armor_class), round,
+                                  outcome};
+            if (!follows(records.empty() ? nullptr : &records.back(), duel))
+                return false;
+            records.push_back(duel);
+        }
+        records_ = std::move(records);
+        return true;
+    }
+
+private:
+    static constexpr char MAGIC[8] = {'K', 'N', 'I', 'G', 'H', 'T', 'S', 'L'};
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+    static constexpr size_t HEADER_SIZE = sizeof(MAGIC) + 2 * sizeof(uint32_t) + sizeof(uint64_t);
+    static constexpr size_t RECORD_SIZE = 4 * sizeof(uint64_t) + sizeof(uint32_t) + sizeof(int8_t);
+
+    template <typename T>
+    static char *put(char *out, const T value) {
+        std::memcpy(out, &value, sizeof(value));
+        return out + sizeof(value);
+    }
+
+    template <typename T>
+    static const char *get(const char *in, T &value, const bool swapped) {
+        char bytes[sizeof(T)];
+        std::copy(in, in + sizeof(T), bytes);
+        if (swapped)
+            std::reverse(bytes, bytes + sizeof(T));
+        std::memcpy(&value, bytes, sizeof(T));
+        return in + sizeof(T);
+    }
+
+    // Tells whether play() could have logged duel right after previous, or
+    // as its first duel if previous is null: pairs fight in order, round
+    // after round, and a draw changes nothing.
+    static bool follows(const DuelRecord *previous, const DuelRecord &duel) {
+        if (duel.outcome < -1 || duel.outcome > 1)
+            return false;
+        if (duel.outcome == 0 && (duel.gold != 0 || duel.weapon_class != 0 || duel.armor_class != 0))
+            return false;
+        if (previous == nullptr)
+            return duel.round == 0 && duel.first == 0;
+        if (duel.round == previous->round)
+            return duel.first == previous->first + 2;
+        return duel.round == previous->round + 1 && duel.first == 0;
+    }
+
+    // Hooks of a round of replay(), which take the outcomes and transfers
+    // from the records.
+    struct Replay : KnightRound<std::vector<Knight>> {
+        const std::vector<DuelRecord> &records;
+        State &state;
+        size_t next = 0;
+        uint32_t round = 0;
+
+        int outcome(const size_t first) const {
+            if (next == records.size() || records[next].round != round || records[next].first != first)
+                throw std::invalid_argument("Event log does not match the tournament.");
+            return records[next].outcome;
+        }
+
+        void fight(const size_t first, const int outcome) {
+            const DuelRecord &record = records[next++];
+            if (outcome == 0)
+                return;
+
+            Knight &winner = knights[outcome > 0 ? first : first + 1];
+            Knight &loser = knights[outcome > 0 ? first + 1 : first];
+            winner.take_gold(record.gold);
+            loser.give_gold();
+            if (record.weapon_class != 0) {
+                winner.change_weapon(record.weapon_class);
+                loser.give_up_weapon();
+            }
+            if (record.armor_class != 0) {
+                winner.change_armour(record.armor_class);
+                loser.take_off_armour();
+            }
+        }
+
+        void eliminate(const size_t position) {
+            state.eliminated.push_back(knights[position]);
+        }
+    };
+
+    std::vector<DuelRecord> records_;
+};
+
+// Tournament whose play() reports every duel to LogPolicy, which is either
+// NoEventLog or EventLog. Contestants are kept in a vector, so iterators
+// returned by play() and no_winner() are invalidated by any later change of
+// the tournament, unlike those of the first version, which used a list.
+template <typename LogPolicy>
+class BasicTournament {
 public:
-    using knight_list = std::list<Knight>;
+    using knight_list = std::vector<Knight>;
 
     template<typename T>
     struct dependent_false : std::false_type {};
 
     template <typename Container>
-    Tournament(const Container& knights) {
+    BasicTournament(const Container& knights) {
         if constexpr (requires { knights.begin(); knights.end(); })
             contestants.assign(knights.begin(), knights.end());
         else if constexpr (requires { knights.size(); knights[0]; })
             for (size_t i = 0; i < knights.size(); i++)
                 contestants.push_back(knights[i]);
         else
-            static_assert(dependent_false<Container>::value, "Container type not supported by Tournament.");
+            static_assert(dependent_false<Container>::value, "Container type not supported by BasicTournament.");
 
         if (contestants.empty())
             contestants.push_back(TRAINEE_KNIGHT);
     }
 
-    Tournament(std::initializer_list<Knight> knights) : contestants(knights) {
+    BasicTournament(std::initializer_list<Knight> knights) : contestants(knights) {
         if (contestants.empty())
             contestants.push_back(TRAINEE_KNIGHT);
     }
 
-    Tournament(const Tournament &) = default;
-    Tournament(Tournament &&) = default;
-    Tournament &operator=(const Tournament &) & = default;
-    Tournament &operator=(Tournament &&) & = default;
+    BasicTournament(const BasicTournament &) = default;
+    BasicTournament(BasicTournament &&) = default;
+    BasicTournament &operator=(const BasicTournament &) & = default;
+    BasicTournament &operator=(BasicTournament &&) & = default;
 
-    Tournament& operator+=(const Knight &knight) & {
+    BasicTournament& operator+=(const Knight &knight) & {
         eliminated.clear();
+        if (indexed) {
+            index[key(knight)].push_back(contestants.size());
+            removed.push_back(false);
+        }
         contestants.push_back(knight);
         return *this;
     }
 
-    Tournament& operator-=(const Knight &knight) & {
+    // Removes all contestants with the same attributes as knight in
+    // expected time proportional to their number: they are found through
+    // the index and only marked as removed until the next compaction.
+    BasicTournament& operator-=(const Knight &knight) & {
+        eliminated.clear();
+        erase(knight);
+        compact_if_sparse();
+        return *this;
+    }
+
+    BasicTournament& operator-=(std::initializer_list<Knight> knights) & {
+        return remove(knights);
+    }
+
+    template <typename Container>
+    BasicTournament& remove(const Container &knights) & {
         eliminated.clear();
-        contestants.erase(
-        std::remove_if(contestants.begin(), contestants.end(),
-                    [&knight](const Knight& k) {
-                        if (k.get_armour_class() != knight.get_armour_class())
-                            return false;
-                        if (k.get_weapon_class() != knight.get_weapon_class())
-                            return false;
-                        if (k.get_gold() != knight.get_gold())
-                            return false;
-                        return true;
-                    }),
-            contestants.end()
-        );
+        for (const Knight &knight : knights)
+            erase(knight);
+        compact_if_sparse();
         return *this;
     }
 
+    // Plays the tournament round by round: in every round the contestants
+    // pair off in order, which is exactly the sequence of fights of the
+    // original queue. Eliminated knights are appended, so the list is kept
+    // in reverse order. The returned iterator is valid only until the next
+    // operator+=, operator-=, remove() or play(): adding a knight may
+    // reallocate the contestants and removing one may compact them, so the
+    // winner has to be copied if it is needed after that.
     knight_list::const_iterator play() & {
         eliminated.clear();
-        while (contestants.size() > 1) {
-            Knight knight1 = contestants.front();
-            contestants.pop_front();
-            Knight knight2 = contestants.front();
-            contestants.pop_front();
-
-            if (knight1 > knight2) {
-                knight1 += knight2;
-                contestants.push_back(knight1);
-                eliminated.push_front(knight2);
-            } else if (knight2 > knight1) {
-                knight2 += knight1;
-                contestants.push_back(knight2);
-                eliminated.push_front(knight1);
-            } else {
-                eliminated.push_front(knight2);
-                eliminated.push_front(knight1);
-            }
+        compact();
+        eliminated.reserve(contestants.size());
+        if constexpr (LogPolicy::enabled) {
+            events.clear();
+            events.reserve(contestants.size());
         }
+
+        for (uint32_t round = 0; contestants.size() > 1; round++)
+            play_round(round);
+
         return contestants.empty() ? no_winner() : contestants.begin();
     }
 
@@ -221,44 +710,659 @@ public:
 
     knight_list::const_iterator no_winner() const && = delete;
 
+    // The duels of the last play(), when LogPolicy keeps them.
+    const LogPolicy &event_log() const {
+        return events;
+    }
+
     size_t size() const {
-        return contestants.size() + eliminated.size();
+        return contestants.size() - removed_count + eliminated.size();
     }
 
-    friend std::ostream &operator<<(std::ostream &os, const Tournament &tournament) {
-        for (const auto &knight: tournament.contestants)
-            os << "+ " << knight;
+    friend std::ostream &operator<<(std::ostream &os, const BasicTournament &tournament) {
+        for (size_t i = 0; i < tournament.contestants.size(); i++)
+            if (tournament.removed_count == 0 || !tournament.removed[i])
+                os << "+ " << tournament.contestants[i];
 
-        for (const auto &knight: tournament.eliminated)
-            os << "- " << knight;
+        for (auto it = tournament.eliminated.rbegin(); it != tournament.eliminated.rend(); ++it)
+            os << "- " << *it;
 
         os << "=\n";
         return os;
     }
 
 private:
+    struct Key {
+        size_t gold, weapon_class, armor_class;
+
+        bool operator==(const Key &) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &key) const {
+            size_t hash = key.gold;
+            hash = (hash ^ (hash >> 31)) * 0x9e3779b97f4a7c15 + key.weapon_class;
+            hash = (hash ^ (hash >> 31)) * 0x9e3779b97f4a7c15 + key.armor_class;
+            return hash ^ (hash >> 29);
+        }
+    };
+
+    static Key key(const Knight &knight) {
+        return {knight.get_gold(), knight.get_weapon_class(), knight.get_armour_class()};
+    }
+
+    void erase(const Knight &knight) {
+        if (!indexed) {
+            for (size_t i = 0; i < contestants.size(); i++)
+                index[key(contestants[i])].push_back(i);
+            removed.assign(contestants.size(), false);
+            indexed = true;
+        }
+
+        const auto it = index.find(key(knight));
+        if (it == index.end())
+            return;
+
+        for (const size_t i : it->second)
+            removed[i] = true;
+        removed_count += it->second.size();
+        index.erase(it);
+    }
+
+    // Removed contestants are dropped once they make up more than half of
+    // the list, so the cost of compaction and of rebuilding the index is
+    // spread over the removals.
+    void compact_if_sparse() {
+        if (removed_count * 2 > contestants.size())
+            compact();
+    }
+
+    // Drops removed contestants together with the index.
+    void compact() {
+        if (removed_count != 0) {
+            size_t kept = 0;
+            for (size_t i = 0; i < contestants.size(); i++)
+                if (!removed[i])
+                    contestants[kept++] = contestants[i];
+            contestants.erase(contestants.begin() + static_cast<std::ptrdiff_t>(kept), contestants.end());
+        }
+
+        index.clear();
+        removed.clear();
+        removed_count = 0;
+        indexed = false;
+    }
+
+    static bool same_classes(const Knight &knight1, const Knight &knight2) {
+        return knight1.get_weapon_class() == knight2.get_weapon_class()
+               && knight1.get_armour_class() == knight2.get_armour_class();
+    }
+
+    // Hooks of a round of play(): losers are appended to eliminated and
+    // duels reported to events. Knights with the same classes always draw,
+    // so such pairs are eliminated without comparing them.
+    struct Round : KnightRound<knight_list> {
+        BasicTournament &tournament;
+        uint32_t round;
+
+        int outcome(const size_t first) const {
+            if (same_classes(knights[first], knights[first + 1]))
+                return 0;
+            return KnightRound::outcome(first);
+        }
+
+        void fight(const size_t first, const int outcome) {
+            if constexpr (LogPolicy::enabled) {
+                const Knight &winner = knights[outcome >= 0 ? first : first + 1];
+                const Knight &loser = knights[outcome >= 0 ? first + 1 : first];
+                if (outcome == 0)
+                    tournament.events.record({first, 0, 0, 0, round, 0});
+                else
+                    tournament.events.record(
+                        {first, loser.get_gold(),
+                         loser.get_weapon_class() > winner.get_weapon_class() ? loser.get_weapon_class() : 0,
+                         loser.get_armour_class() > winner.get_armour_class() ? loser.get_armour_class() : 0,
+                         round, static_cast<int8_t>(outcome)});
+            }
+            KnightRound::fight(first, outcome);
+        }
+
+        void eliminate(const size_t position) {
+            tournament.eliminated.push_back(knights[position]);
+        }
+    };
+
+    // Plays one round in a single pass, compacting the winners to the front
+    // of contestants. The odd knight out, if any, fights first in the next
+    // round.
+    void play_round(const uint32_t round) {
+        Round hooks{{contestants}, *this, round};
+        const size_t survivors = play_tournament_round(hooks, contestants.size());
+        contestants.erase(contestants.begin() + static_cast<std::ptrdiff_t>(survivors), contestants.end());
+    }
+
     knight_list contestants, eliminated;
+    // Built on the first removal and dropped whenever contestants are
+    // compacted or fight: positions of contestants by attributes, and
+    // which of them have been removed since.
+    std::unordered_map<Key, std::vector<size_t>, KeyHash> index;
+    std::vector<bool> removed;
+    size_t removed_count = 0;
+    bool indexed = false;
+    [[no_unique_address]] LogPolicy events;
 };
 
-template <typename Container>
-consteval std::pair<size_t, size_t> max_diff_classes(Container knights) {
-    std::pair<size_t, size_t> max_diff(0, 0);
-    for (const auto& knight : knights) {
-        const size_t diff = knight.get_armour_class() > knight.get_weapon_class()
-                                ? knight.get_armour_class() - knight.get_weapon_class()
-                                : knight.get_weapon_class() - knight.get_armour_class();
+using Tournament = BasicTournament<NoEventLog>;
+
+// Tournament of at most N knights kept in fixed-capacity arrays, so that it
+// can be set up and played at compile time. Follows the rules and the
+// interface of Tournament; exceeding the capacity throws std::length_error.
+template <size_t N>
+class StaticTournament {
+    static_assert(N > 0, "StaticTournament needs room for at least one knight.");
+
+public:
+    using const_iterator = const Knight *;
+
+    template<typename T>
+    struct dependent_false : std::false_type {};
+
+    template <typename Container>
+    constexpr StaticTournament(const Container &knights)
+        : contestants(filled(std::make_index_sequence<N>())), eliminated(contestants) {
+        if constexpr (requires { knights.begin(); knights.end(); })
+            for (const Knight &knight : knights)
+                append(knight);
+        else if constexpr (requires { knights.size(); knights[0]; })
+            for (size_t i = 0; i < knights.size(); i++)
+                append(knights[i]);
+        else
+            static_assert(dependent_false<Container>::value, "Container type not supported by StaticTournament.");
+
+        if (contestants_count == 0)
+            contestants[contestants_count++] = TRAINEE_KNIGHT;
+    }
+
+    constexpr StaticTournament(std::initializer_list<Knight> knights)
+        : contestants(filled(std::make_index_sequence<N>())), eliminated(contestants) {
+        for (const Knight &knight : knights)
+            append(knight);
+
+        if (contestants_count == 0)
+            contestants[contestants_count++] = TRAINEE_KNIGHT;
+    }
+
+    constexpr StaticTournament(const StaticTournament &) = default;
+    constexpr StaticTournament(StaticTournament &&) = default;
+    constexpr StaticTournament &operator=(const StaticTournament &) & = default;
+    constexpr StaticTournament &operator=(StaticTournament &&) & = default;
+
+    constexpr StaticTournament &operator+=(const Knight &knight) & {
+        append(knight);
+        eliminated_count = 0;
+        return *this;
+    }
+
+    constexpr StaticTournament &operator-=(const Knight &knight) & {
+        eliminated_count = 0;
+        size_t kept = 0;
+        for (size_t i = 0; i < contestants_count; i++)
+            if (contestants[i].get_gold() != knight.get_gold()
+                || contestants[i].get_weapon_class() != knight.get_weapon_class()
+                || contestants[i].get_armour_class() != knight.get_armour_class())
+                contestants[kept++] = contestants[i];
+        contestants_count = kept;
+        return *this;
+    }
+
+    // Plays the same rounds as Tournament::play().
+    constexpr const_iterator play() & {
+        eliminated_count = 0;
+        Round round{{contestants}, *this};
+        while (contestants_count > 1)
+            contestants_count = play_tournament_round(round, contestants_count);
+        return contestants_count == 0 ? no_winner() : contestants.data();
+    }
+
+    constexpr const_iterator no_winner() const & {
+        return contestants.data() + contestants_count;
+    }
+
+    constexpr const_iterator no_winner() const && = delete;
+
+    constexpr size_t size() const {
+        return contestants_count + eliminated_count;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const StaticTournament &tournament) {
+        for (size_t i = 0; i < tournament.contestants_count; i++)
+            os << "+ " << tournament.contestants[i];
+
+        for (size_t i = tournament.eliminated_count; i-- > 0;)
+            os << "- " << tournament.eliminated[i];
+
+        os << "=\n";
+        return os;
+    }
+
+private:
+    // Hooks of a round of play(), which keep eliminated knights.
+    struct Round : KnightRound<std::array<Knight, N>> {
+        StaticTournament &tournament;
+
+        constexpr void eliminate(const size_t position) {
+            tournament.eliminated[tournament.eliminated_count++] = this->knights[position];
+        }
+    };
+
+    constexpr void append(const Knight &knight) {
+        if (contestants_count == N)
+            throw std::length_error("Too many knights for StaticTournament.");
+        contestants[contestants_count++] = knight;
+    }
+
+    template <size_t... I>
+    static constexpr std::array<Knight, N> filled(std::index_sequence<I...>) {
+        return {{(static_cast<void>(I), TRAINEE_KNIGHT)...}};
+    }
+
+    // Eliminated knights are kept in reverse order, as in Tournament.
+    std::array<Knight, N> contestants, eliminated;
+    size_t contestants_count = 0, eliminated_count = 0;
+};
+
+// Aggregated results of many tournaments played by variants of one roster.
+// Per-knight counters are indexed by position in the base roster.
+struct TournamentStats {
+    size_t tournaments = 0;
+    size_t no_winner = 0;
+    std::vector<size_t> wins;
+    std::vector<size_t> duels_won;
+    // Sum over won tournaments of the winner's share of all the gold.
+    double winner_gold_share = 0;
+
+    double mean_winner_gold_share() const {
+        const size_t won = tournaments - no_winner;
+        return won == 0 ? 0 : winner_gold_share / static_cast<double>(won);
+    }
+
+    TournamentStats &operator+=(const TournamentStats &other) & {
+        tournaments += other.tournaments;
+        no_winner += other.no_winner;
+        winner_gold_share += other.winner_gold_share;
+        wins.resize(std::max(wins.size(), other.wins.size()));
+        duels_won.resize(std::max(duels_won.size(), other.duels_won.size()));
+        for (size_t i = 0; i < other.wins.size(); i++)
+            wins[i] += other.wins[i];
+        for (size_t i = 0; i < other.duels_won.size(); i++)
+            duels_won[i] += other.duels_won[i];
+        return *this;
+    }
+};
+
+// Plays count tournaments, each on a variant of roster prepared by
+// generate(index, order, knights): order starts as 0, 1, ..., n - 1 and
+// knights as a copy of roster, and the generator may permute the former
+// and change the latter. Knight order[j] enters the tournament j-th. The
+// generator is called concurrently and should depend only on index and
+// its arguments. Tournaments are spread over a pool of threads, each with
+// its own buffers and statistics; idle threads steal half of the largest
+// remaining range of indices.
+template <typename Generator>
+TournamentStats simulate_tournaments(const std::vector<Knight> &roster, const size_t count, Generator generate,
+                                     size_t threads = std::thread::hardware_concurrency()) {
+    constexpr size_t CHUNK = 16;
+    threads = std::max<size_t>(1, std::min(threads, count / CHUNK + 1));
+
+    struct Range {
+        std::mutex mutex;
+        size_t begin, end;
+    };
+    std::vector<Range> ranges(threads);
+    for (size_t t = 0; t < threads; t++) {
+        ranges[t].begin = count * t / threads;
+        ranges[t].end = count * (t + 1) / threads;
+    }
+
+    std::vector<TournamentStats> stats(threads);
+    std::vector<std::exception_ptr> errors(threads);
+
+    // The same rounds as Tournament::play(), keeping track of the knights'
+    // positions in the roster.
+    struct Round : KnightRound<std::vector<Knight>> {
+        std::vector<size_t> &ids;
+        std::vector<size_t> &duels_won;
+
+        void fight(const size_t first, const int outcome) {
+            if (outcome != 0)
+                duels_won[ids[outcome > 0 ? first : first + 1]]++;
+            KnightRound::fight(first, outcome);
+        }
+
+        void move(const size_t from, const size_t to) {
+            KnightRound::move(from, to);
+            ids[to] = ids[from];
+        }
+    };
+
+    auto take = [&ranges](Range &range, size_t &begin, size_t &end) {
+        std::lock_guard lock(range.mutex);
+        begin = range.begin;
+        end = std::min(range.end, begin + CHUNK);
+        range.begin = end;
+        return begin < end;
+    };
+
+    auto steal = [&ranges, threads](size_t self) {
+        while (true) {
+            size_t victim = threads, largest = 0;
+            for (size_t t = 0; t < threads; t++) {
+                std::lock_guard lock(ranges[t].mutex);
+                if (t != self && ranges[t].end - ranges[t].begin > largest) {
+                    largest = ranges[t].end - ranges[t].begin;
+                    victim = t;
+                }
+            }
+            if (victim == threads)
+                return false;
+
+            size_t begin, end;
+            {
+                std::lock_guard lock(ranges[victim].mutex);
+                end = ranges[victim].end;
+                begin = end - (end - ranges[victim].begin + 1) / 2;
+                ranges[victim].end = begin;
+            }
+            if (begin == end)
+                continue;
+
+            std::lock_guard lock(ranges[self].mutex);
+            ranges[self].begin = begin;
+            ranges[self].end = end;
+            return true;
+        }
+    };
 
-        const size_t tmp = max_diff.second > max_diff.first
-                                ? max_diff.second - max_diff.first
-                                : max_diff.first - max_diff.second;
-        if (diff >= tmp)
-            max_diff = std::make_pair(knight.get_weapon_class(), knight.get_armour_class());
+    auto work = [&](size_t self) {
+        TournamentStats &result = stats[self];
+        result.wins.assign(roster.size(), 0);
+        result.duels_won.assign(roster.size(), 0);
+        std::vector<size_t> order(roster.size()), ids(roster.size());
+        std::vector<Knight> knights = roster, contestants = roster;
+        Round round{{contestants}, ids, result.duels_won};
+
+        try {
+            size_t begin, end;
+            while (take(ranges[self], begin, end) || (steal(self) && take(ranges[self], begin, end))) {
+                for (size_t index = begin; index < end; index++) {
+                    std::iota(order.begin(), order.end(), 0);
+                    std::copy(roster.begin(), roster.end(), knights.begin());
+                    generate(index, order, knights);
+
+                    size_t total_gold = 0;
+                    for (size_t j = 0; j < order.size(); j++) {
+                        contestants[j] = knights[order[j]];
+                        ids[j] = order[j];
+                        total_gold = std::min(Knight::MAX_GOLD - contestants[j].get_gold(), total_gold)
+                                     + contestants[j].get_gold();
+                    }
+
+                    size_t size = order.size();
+                    while (size > 1)
+                        size = play_tournament_round(round, size);
+
+                    result.tournaments++;
+                    if (size == 0) {
+                        result.no_winner++;
+                        continue;
+                    }
+                    result.wins[ids[0]]++;
+                    if (total_gold != 0)
+                        result.winner_gold_share += static_cast<double>(contestants[0].get_gold())
+                                                    / static_cast<double>(total_gold);
+                    else
+                        result.winner_gold_share += 1;
+                }
+            }
+        } catch (...) {
+            errors[self] = std::current_exception();
+            for (Range &range : ranges) {
+                std::lock_guard lock(range.mutex);
+                range.begin = range.end;
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; t++)
+        pool.emplace_back(work, t);
+    work(0);
+    for (std::thread &thread : pool)
+        thread.join();
+
+    for (const std::exception_ptr &error : errors)
+        if (error)
+            std::rethrow_exception(error);
+
+    TournamentStats result;
+    result.wins.assign(roster.size(), 0);
+    result.duels_won.assign(roster.size(), 0);
+    for (const TournamentStats &partial : stats)
+        result += partial;
+    return result;
+}
+
+// Roster analytics. Each statistic has a constexpr version over a range of
+// knights and, except for dominance counts, a runtime version that splits a
+// span of knights into contiguous chunks reduced on separate threads.
+
+// Weapon and armour classes of the last knight whose classes differ the
+// most, or (0, 0) for no knights.
+template <typename Iterator>
+constexpr std::pair<size_t, size_t> max_diff_classes(Iterator first, Iterator last) {
+    std::pair<size_t, size_t> max_diff(0, 0);
+    size_t max = 0;
+    for (; first != last; ++first) {
+        const size_t weapon_class = first->get_weapon_class(), armor_class = first->get_armour_class();
+        const size_t diff = weapon_class > armor_class ? weapon_class - armor_class : armor_class - weapon_class;
+        if (diff >= max) {
+            max = diff;
+            max_diff = std::make_pair(weapon_class, armor_class);
+        }
     }
     return max_diff;
 }
 
+template <typename Container>
+consteval std::pair<size_t, size_t> max_diff_classes(Container knights) {
+    return max_diff_classes(knights.begin(), knights.end());
+}
+
 consteval std::pair<size_t, size_t> max_diff_classes(std::initializer_list<Knight> knights) {
     return max_diff_classes<std::initializer_list<Knight>>(knights);
 }
 
+// Total gold of the knights, capped at Knight::MAX_GOLD.
+template <typename Iterator>
+constexpr size_t total_gold(Iterator first, Iterator last) {
+    size_t total = 0;
+    for (; first != last; ++first) {
+        const size_t sum = total + first->get_gold();
+        total = sum | -static_cast<size_t>(sum < total);
+    }
+    return total;
+}
+
+// Numbers of knights by weapon and by armour class, the last of the bins
+// counting all classes from its index up.
+struct ClassHistogram {
+    std::vector<size_t> weapon, armour;
+};
+
+template <typename Iterator>
+constexpr ClassHistogram class_histogram(Iterator first, Iterator last, const size_t bins) {
+    ClassHistogram histogram{std::vector<size_t>(bins), std::vector<size_t>(bins)};
+    if (bins == 0)
+        return histogram;
+
+    for (; first != last; ++first) {
+        histogram.weapon[std::min(first->get_weapon_class(), bins - 1)]++;
+        histogram.armour[std::min(first->get_armour_class(), bins - 1)]++;
+    }
+    return histogram;
+}
+
+// For every knight, the number of knights it beats under operator<=>, in
+// O(n log n) rather than by comparing all pairs. Knight A beats B when
+// weapon(A) > armour(B), unless weapon(B) > armour(A) and either
+// armour(B) > armour(A) or armour(B) == armour(A) and weapon(B) >= weapon(A).
+// Hence the count is the number of knights with armour below weapon(A),
+// less those with armour strictly between armour(A) and weapon(A) and
+// weapon above armour(A), found by a sweep over a Fenwick tree, less those
+// with armour(A) and weapon at least weapon(A), found by binary search.
+template <typename Iterator>
+constexpr std::vector<size_t> dominance_counts(Iterator first, Iterator last) {
+    std::vector<std::pair<size_t, size_t>> classes;
+    for (; first != last; ++first)
+        classes.emplace_back(first->get_armour_class(), first->get_weapon_class());
+
+    const size_t count = classes.size();
+    std::vector<std::pair<size_t, size_t>> sorted = classes;
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<size_t> armours;
+    for (const auto &[armour_class, weapon_class] : sorted)
+        if (armours.empty() || armours.back() != armour_class)
+            armours.push_back(armour_class);
+
+    std::vector<size_t> by_weapon(count), by_armour(count);
+    std::iota(by_weapon.begin(), by_weapon.end(), 0);
+    std::iota(by_armour.begin(), by_armour.end(), 0);
+    std::sort(by_weapon.begin(), by_weapon.end(),
+              [&classes](size_t i, size_t j) { return classes[i].second > classes[j].second; });
+    std::sort(by_armour.begin(), by_armour.end(),
+              [&classes](size_t i, size_t j) { return classes[i].first > classes[j].first; });
+
+    std::vector<size_t> tree(armours.size() + 1);
+    auto rank = [&armours](size_t armour_class) {
+        return static_cast<size_t>(std::lower_bound(armours.begin(), armours.end(), armour_class) - armours.begin());
+    };
+    auto prefix = [&tree](size_t end) {
+        size_t sum = 0;
+        for (; end > 0; end &= end - 1)
+            sum += tree[end];
+        return sum;
+    };
+
+    std::vector<size_t> counts(count);
+    size_t inserted = 0;
+    for (const size_t i : by_armour) {
+        const auto [armour_class, weapon_class] = classes[i];
+        for (; inserted < count && classes[by_weapon[inserted]].second > armour_class; inserted++)
+            for (size_t j = rank(classes[by_weapon[inserted]].first) + 1; j < tree.size(); j += j & -j)
+                tree[j]++;
+
+        const size_t below = static_cast<size_t>(
+            std::lower_bound(sorted.begin(), sorted.end(), std::make_pair(weapon_class, size_t{0})) - sorted.begin());
+        if (weapon_class <= armour_class) {
+            counts[i] = below;
+            continue;
+        }
+
+        const size_t between = prefix(rank(weapon_class)) - prefix(rank(armour_class) + 1);
+        const size_t stronger = static_cast<size_t>(
+            std::upper_bound(sorted.begin(), sorted.end(), std::make_pair(armour_class, std::numeric_limits<size_t>::max()))
+            - std::lower_bound(sorted.begin(), sorted.end(), std::make_pair(armour_class, weapon_class)));
+        counts[i] = below - between - stronger;
+    }
+    return counts;
+}
+
+// Reduces contiguous chunks of knights with reduce(first, last) on up to
+// threads threads, and combines the partial results in order.
+template <typename Result, typename Reduce, typename Combine>
+Result reduce_chunks(std::span<const Knight> knights, size_t threads, Reduce reduce, Combine combine) {
+    constexpr size_t MIN_CHUNK = size_t{1} << 14;
+    threads = std::max<size_t>(1, std::min(threads, knights.size() / MIN_CHUNK));
+
+    std::vector<Result> partial(threads);
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; t++)
+        pool.emplace_back([&, t] {
+            partial[t] = reduce(knights.begin() + static_cast<std::ptrdiff_t>(knights.size() * t / threads),
+                                knights.begin() + static_cast<std::ptrdiff_t>(knights.size() * (t + 1) / threads));
+        });
+    partial[0] = reduce(knights.begin(), knights.begin() + static_cast<std::ptrdiff_t>(knights.size() / threads));
+    for (std::thread &thread : pool)
+        thread.join();
+
+    Result result = std::move(partial[0]);
+    for (size_t t = 1; t < threads; t++)
+        result = combine(std::move(result), std::move(partial[t]));
+    return result;
+}
+
+inline std::pair<size_t, size_t> parallel_max_diff_classes(std::span<const Knight> knights,
+                                                           size_t threads = std::thread::hardware_concurrency()) {
+    struct Partial {
+        size_t diff = 0;
+        std::pair<size_t, size_t> classes{0, 0};
+        bool found = false;
+    };
+
+    // Finds the largest difference first, in a loop the compiler can
+    // vectorise, and then the last knight with it.
+    auto reduce = [](std::span<const Knight>::iterator first, std::span<const Knight>::iterator last) {
+        auto diff = [](const Knight &knight) {
+            const size_t weapon_class = knight.get_weapon_class(), armor_class = knight.get_armour_class();
+            return weapon_class > armor_class ? weapon_class - armor_class : armor_class - weapon_class;
+        };
+
+        size_t max = 0;
+        for (auto it = first; it != last; ++it)
+            max = std::max(max, diff(*it));
+
+        Partial partial;
+        for (auto it = last; it != first;) {
+            --it;
+            if (diff(*it) == max) {
+                partial = {max, {it->get_weapon_class(), it->get_armour_class()}, true};
+                break;
+            }
+        }
+        return partial;
+    };
+    auto combine = [](Partial left, Partial right) {
+        return right.found && right.diff >= left.diff ? right : left;
+    };
+    return reduce_chunks<Partial>(knights, threads, reduce, combine).classes;
+}
+
+inline size_t parallel_total_gold(std::span<const Knight> knights,
+                                  size_t threads = std::thread::hardware_concurrency()) {
+    return reduce_chunks<size_t>(
+        knights, threads,
+        [](std::span<const Knight>::iterator first, std::span<const Knight>::iterator last) {
+            return total_gold(first, last);
+        },
+        [](size_t left, size_t right) {
+            return std::min(Knight::MAX_GOLD - right, left) + right;
+        });
+}
+
+inline ClassHistogram parallel_class_histogram(std::span<const Knight> knights, const size_t bins,
+                                               size_t threads = std::thread::hardware_concurrency()) {
+    return reduce_chunks<ClassHistogram>(
+        knights, threads,
+        [bins](std::span<const Knight>::iterator first, std::span<const Knight>::iterator last) {
+            return class_histogram(first, last, bins);
+        },
+        [](ClassHistogram left, ClassHistogram right) {
+            for (size_t i = 0; i < left.weapon.size(); i++) {
+                left.weapon[i] += right.weapon[i];
+                left.armour[i] += right.armour[i];
+            }
+            return left;
+        });
+}
+
 #endif // KNIGHTS_H_
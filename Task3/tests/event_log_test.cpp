@@ -0,0 +1,128 @@
+// Test of the binary form of EventLog: logs of random tournaments are written
+// and read back, also in the opposite byte order, and every truncation and
+// corruption of the header or of a record has to be rejected.
+// Usage: event_log_test [seed]
+
+#include "../knights.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr size_t HEADER_SIZE = 24;
+    constexpr size_t RECORD_SIZE = 37;
+    constexpr size_t OUTCOME_OFFSET = RECORD_SIZE - 1;
+
+    size_t failures = 0;
+
+    void check(const char *name, const bool is_correct) {
+        if (!is_correct && failures++ < 10)
+            std::fprintf(stderr, "FAILED: %s\n", name);
+    }
+
+    std::string written(const EventLog &log) {
+        std::ostringstream os;
+        log.write(os);
+        return os.str();
+    }
+
+    bool read(EventLog &log, const std::string &bytes) {
+        std::istringstream is(bytes);
+        return log.read(is);
+    }
+
+    bool same_records(const EventLog &log1, const EventLog &log2) {
+        return std::equal(log1.records().begin(), log1.records().end(), log2.records().begin(),
+                          log2.records().end(), [](const DuelRecord &record1, const DuelRecord &record2) {
+                              return record1.first == record2.first && record1.gold == record2.gold
+                                     && record1.weapon_class == record2.weapon_class
+                                     && record1.armor_class == record2.armor_class
+                                     && record1.round == record2.round && record1.outcome == record2.outcome;
+                          });
+    }
+
+    // Reverses bytes of every number of the binary form, as written on
+    // a machine with the opposite byte order.
+    std::string swapped(std::string bytes) {
+        auto reverse = [&bytes](const size_t offset, const size_t size) {
+            std::reverse(bytes.begin() + static_cast<std::ptrdiff_t>(offset),
+                         bytes.begin() + static_cast<std::ptrdiff_t>(offset + size));
+        };
+        reverse(8, 4);
+        reverse(12, 4);
+        reverse(16, 8);
+        for (size_t record = HEADER_SIZE; record < bytes.size(); record += RECORD_SIZE) {
+            for (size_t field = 0; field < 4; field++)
+                reverse(record + 8 * field, 8);
+            reverse(record + 32, 4);
+        }
+        return bytes;
+    }
+
+    EventLog random_log(std::mt19937_64 &generator) {
+        const size_t count = generator() % 40;
+        const size_t classes = generator() % 6 + 1;
+        std::vector<Knight> knights;
+        for (size_t i = 0; i < count; i++)
+            knights.emplace_back(generator() % 100, generator() % classes, generator() % classes);
+        BasicTournament<EventLog> tournament(knights);
+        tournament.play();
+        return tournament.event_log();
+    }
+
+    void check_log(const EventLog &log) {
+        const std::string bytes = written(log);
+        check("size without padding", bytes.size() == HEADER_SIZE + log.records().size() * RECORD_SIZE);
+
+        EventLog read_log;
+        check("read", read(read_log, bytes) && same_records(read_log, log));
+        EventLog swapped_log;
+        check("read in opposite byte order", read(swapped_log, swapped(bytes)) && same_records(swapped_log, log));
+
+        // A failed read keeps the records read before.
+        for (size_t size = 0; size < bytes.size(); size++)
+            check("truncated", !read(read_log, bytes.substr(0, size)) && same_records(read_log, log));
+        for (size_t offset = 0; offset < 16; offset++) {
+            std::string corrupted = bytes;
+            corrupted[offset] ^= 0x10;
+            check("corrupted header", !read(read_log, corrupted) && same_records(read_log, log));
+        }
+
+        for (size_t record = HEADER_SIZE; record < bytes.size(); record += RECORD_SIZE) {
+            std::string corrupted = bytes;
+            for (const signed char outcome : {2, -2, 127, -128}) {
+                corrupted[record + OUTCOME_OFFSET] = static_cast<char>(outcome);
+                check("invalid outcome", !read(read_log, corrupted));
+            }
+
+            corrupted = bytes;
+            corrupted[record] ^= 0x02;
+            check("duel out of order", !read(read_log, corrupted));
+
+            if (bytes[record + OUTCOME_OFFSET] == 0) {
+                corrupted = bytes;
+                corrupted[record + 8 + 8 * (record % 3)] ^= 0x01;
+                check("draw with transfer", !read(read_log, corrupted));
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::mt19937_64 generator(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1);
+    check_log(EventLog());
+    for (int i = 0; i < 2000; i++)
+        check_log(random_log(generator));
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%zu failures\n", failures);
+        return 1;
+    }
+    return 0;
+}
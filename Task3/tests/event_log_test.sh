@@ -0,0 +1,17 @@
+#!/bin/sh
+# Runs test of writing and reading event logs of tournaments.
+# Usage: tests/event_log_test.sh
+set -eu
+
+cd "$(dirname "$0")/.."
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+CXX=${CXX:-g++}
+FLAGS="-std=c++20 -O2 -Wall -Wextra"
+$CXX $FLAGS tests/event_log_test.cpp -o "$work/test"
+
+for seed in 1 2 3; do
+    "$work/test" "$seed"
+done
+echo "event log test passed"
@@ -0,0 +1,144 @@
+// Test of simulate_tournaments() against BasicTournament::play() on the same
+// variants of random rosters. Every variant is played sequentially and the
+// positions of the knights in the roster are followed through the duels of
+// its event log; the statistics gathered by work stealing on any number of
+// threads have to be the same.
+// Usage: simulation_test [seed]
+
+#include "../knights.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    size_t failures = 0;
+
+    void check(const char *name, const bool is_correct) {
+        if (!is_correct && failures++ < 10)
+            std::fprintf(stderr, "FAILED: %s\n", name);
+    }
+
+    // Variant of the roster depends only on the seed and its index: the
+    // order is shuffled and some knights get different gold.
+    struct Variants {
+        unsigned long long seed;
+
+        void operator()(const size_t index, std::vector<size_t> &order, std::vector<Knight> &knights) const {
+            std::mt19937_64 generator(seed * 0x9e3779b97f4a7c15 + index);
+            std::shuffle(order.begin(), order.end(), generator);
+            for (Knight &knight : knights)
+                if (generator() % 4 == 0)
+                    knight = Knight(generator() % 100, knight.get_weapon_class(), knight.get_armour_class());
+        }
+    };
+
+    // Plays one variant with BasicTournament and adds its result to stats.
+    void play_variant(const std::vector<Knight> &roster, const Variants &variants, const size_t index,
+                      TournamentStats &stats) {
+        std::vector<size_t> order(roster.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::vector<Knight> knights = roster;
+        variants(index, order, knights);
+
+        std::vector<Knight> entered;
+        size_t total_gold = 0;
+        for (const size_t i : order) {
+            entered.push_back(knights[i]);
+            total_gold = std::min(Knight::MAX_GOLD - knights[i].get_gold(), total_gold) + knights[i].get_gold();
+        }
+        BasicTournament<EventLog> tournament(entered);
+        const auto winner = tournament.play();
+        const bool has_winner = winner != tournament.no_winner();
+
+        // Positions in the roster of the contestants of the current round,
+        // moved as play_tournament_round() moves the knights.
+        std::vector<size_t> ids = order, survivors;
+        const std::vector<DuelRecord> &records = tournament.event_log().records();
+        for (size_t next = 0, round = 0; ids.size() > 1; round++) {
+            survivors.assign(ids.size() % 2, ids.back());
+            for (size_t first = 0; first + 1 < ids.size(); first += 2, next++) {
+                if (next == records.size() || records[next].round != round || records[next].first != first) {
+                    check("event log", false);
+                    return;
+                }
+                if (records[next].outcome != 0) {
+                    const size_t id = ids[records[next].outcome > 0 ? first : first + 1];
+                    stats.duels_won[id]++;
+                    survivors.push_back(id);
+                }
+            }
+            ids.swap(survivors);
+        }
+
+        stats.tournaments++;
+        check("winner", has_winner == (ids.size() == 1));
+        if (!has_winner) {
+            stats.no_winner++;
+            return;
+        }
+        stats.wins[ids[0]]++;
+        stats.winner_gold_share += total_gold == 0 ? 1
+                                                   : static_cast<double>(winner->get_gold())
+                                                         / static_cast<double>(total_gold);
+    }
+
+    bool same_stats(const TournamentStats &stats1, const TournamentStats &stats2) {
+        // Shares are summed in a different order on every thread.
+        return stats1.tournaments == stats2.tournaments && stats1.no_winner == stats2.no_winner
+               && stats1.wins == stats2.wins && stats1.duels_won == stats2.duels_won
+               && std::fabs(stats1.winner_gold_share - stats2.winner_gold_share)
+                      <= 1e-9 * std::max(1.0, stats2.winner_gold_share);
+    }
+
+    void check_random(std::mt19937_64 &generator) {
+        const size_t count = generator() % 40 + 1;
+        const size_t classes = generator() % 6 + 1;
+        std::vector<Knight> roster;
+        for (size_t i = 0; i < count; i++)
+            roster.emplace_back(generator() % 100, generator() % classes, generator() % classes);
+        const Variants variants{generator()};
+
+        // Small counts leave some of the threads without tournaments.
+        const size_t tournaments = generator() % 2 == 0 ? generator() % 40 : generator() % 2000;
+        TournamentStats expected;
+        expected.wins.assign(count, 0);
+        expected.duels_won.assign(count, 0);
+        for (size_t index = 0; index < tournaments; index++)
+            play_variant(roster, variants, index, expected);
+
+        for (const size_t threads : {1, 2, 3, 8})
+            check("statistics", same_stats(simulate_tournaments(roster, tournaments, variants, threads), expected));
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::mt19937_64 generator(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1);
+    for (int i = 0; i < 200; i++)
+        check_random(generator);
+
+    // An exception thrown by the generator on any thread stops the others
+    // and is thrown again by simulate_tournaments().
+    bool thrown = false;
+    try {
+        simulate_tournaments({Knight(1, 1, 1), Knight(2, 2, 2)}, 1000,
+                             [](const size_t index, std::vector<size_t> &, std::vector<Knight> &) {
+                                 if (index == 777)
+                                     throw std::runtime_error("generator failed");
+                             }, 4);
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    check("exception from generator", thrown);
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%zu failures\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,18 @@
+#!/bin/sh
+# Runs test of simulate_tournaments() against sequential play() of the same
+# tournaments, on several numbers of threads.
+# Usage: tests/simulation_test.sh
+set -eu
+
+cd "$(dirname "$0")/.."
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+CXX=${CXX:-g++}
+FLAGS="-std=c++20 -O2 -Wall -Wextra -pthread"
+$CXX $FLAGS tests/simulation_test.cpp -o "$work/test"
+
+for seed in 1 2 3; do
+    "$work/test" "$seed"
+done
+echo "simulation test passed"
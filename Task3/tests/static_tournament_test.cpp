@@ -0,0 +1,130 @@
+// Test of StaticTournament against Tournament::play() on the same rosters.
+// Fixed rosters are played at compile time and their results, printed at
+// run time, have to match the runtime tournaments; random rosters are played
+// by both at run time.
+// Usage: static_tournament_test [seed]
+
+#include "../knights.h"
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr std::array<Knight, 5> ROSTER{Knight(5, 3, 1), Knight(7, 2, 4), Knight(1, 5, 2), Knight(9, 1, 1),
+                                           Knight(2, 4, 4)};
+    constexpr std::array<Knight, 2> DRAWING_ROSTER{Knight(1, 1, 1), Knight(2, 1, 1)};
+
+    // Tournament on ROSTER changed in the same way by changed().
+    template <typename AnyTournament>
+    constexpr AnyTournament changed(AnyTournament tournament) {
+        tournament += Knight(3, 6, 0);
+        tournament -= Knight(9, 1, 1);
+        return tournament;
+    }
+
+    template <typename AnyTournament>
+    constexpr AnyTournament played(AnyTournament tournament) {
+        tournament.play();
+        return tournament;
+    }
+
+    constexpr auto PLAYED = played(changed(StaticTournament<8>(ROSTER)));
+    constexpr auto PLAYED_DRAWING = played(StaticTournament<2>(DRAWING_ROSTER));
+    constexpr auto PLAYED_EMPTY = played(StaticTournament<1>{});
+
+    // The winners are known at compile time.
+    static_assert([] {
+        StaticTournament<8> tournament = changed(StaticTournament<8>(ROSTER));
+        const Knight winner = *tournament.play();
+        return winner.get_gold() == 18 && winner.get_weapon_class() == 6 && winner.get_armour_class() == 4
+               && tournament.size() == 5;
+    }());
+
+    static_assert([] {
+        StaticTournament<2> tournament(DRAWING_ROSTER);
+        return tournament.play() == tournament.no_winner() && tournament.size() == 2;
+    }());
+
+    static_assert([] {
+        StaticTournament<1> tournament{};
+        const Knight winner = *tournament.play();
+        return winner.get_gold() == 0 && winner.get_weapon_class() == 1 && winner.get_armour_class() == 1;
+    }());
+
+    size_t failures = 0;
+
+    template <typename AnyTournament>
+    std::string printed(const AnyTournament &tournament) {
+        std::ostringstream os;
+        os << tournament << tournament.size() << "\n";
+        return os.str();
+    }
+
+    void check(const std::string &name, const std::string &result, const std::string &expected) {
+        if (result != expected && failures++ < 10)
+            std::fprintf(stderr, "FAILED: %s\n%s\ninstead of\n%s\n", name.c_str(), result.c_str(),
+                         expected.c_str());
+    }
+
+    // Plays a random roster, with some of its knights removed and added
+    // again, in both tournaments.
+    void check_random(std::mt19937_64 &generator) {
+        constexpr size_t MAX_KNIGHTS = 24;
+        const size_t count = generator() % (MAX_KNIGHTS / 2 + 1);
+        const size_t classes = generator() % 6 + 1;
+        std::vector<Knight> knights;
+        for (size_t i = 0; i < count; i++)
+            knights.emplace_back(generator() % 100, generator() % classes, generator() % classes);
+
+        Tournament tournament(knights);
+        StaticTournament<MAX_KNIGHTS> static_tournament(knights);
+        check("container constructor", printed(static_tournament), printed(tournament));
+        for (size_t i = 0; i < count / 2; i++) {
+            const Knight knight = knights[generator() % count];
+            tournament -= knight;
+            static_tournament -= knight;
+            if (generator() % 2 == 0) {
+                tournament += knight;
+                static_tournament += knight;
+            }
+        }
+
+        const auto winner = tournament.play();
+        const bool has_winner = winner != tournament.no_winner();
+        const auto static_winner = static_tournament.play();
+        const bool static_has_winner = static_winner != static_tournament.no_winner();
+        check("random roster", printed(static_tournament) + std::to_string(static_has_winner),
+              printed(tournament) + std::to_string(has_winner));
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::mt19937_64 generator(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1);
+
+    check("compile-time roster", printed(PLAYED), printed(played(changed(Tournament(ROSTER)))));
+    check("compile-time draw", printed(PLAYED_DRAWING), printed(played(Tournament(DRAWING_ROSTER))));
+    check("compile-time empty roster", printed(PLAYED_EMPTY), printed(played(Tournament{})));
+
+    for (int i = 0; i < 20000; i++)
+        check_random(generator);
+
+    bool thrown = false;
+    try {
+        StaticTournament<1> tournament{Knight(1, 1, 1)};
+        tournament += TRAINEE_KNIGHT;
+    } catch (const std::length_error &) {
+        thrown = true;
+    }
+    check("capacity", std::to_string(thrown), "1");
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%zu failures\n", failures);
+        return 1;
+    }
+    return 0;
+}
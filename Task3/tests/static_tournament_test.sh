@@ -0,0 +1,18 @@
+#!/bin/sh
+# Runs test of StaticTournament against Tournament::play(). Fixed rosters are
+# checked when the test is compiled and again when it runs.
+# Usage: tests/static_tournament_test.sh
+set -eu
+
+cd "$(dirname "$0")/.."
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+CXX=${CXX:-g++}
+FLAGS="-std=c++20 -O2 -Wall -Wextra"
+$CXX $FLAGS tests/static_tournament_test.cpp -o "$work/test"
+
+for seed in 1 2 3; do
+    "$work/test" "$seed"
+done
+echo "static tournament test passed"